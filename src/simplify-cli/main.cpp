@@ -0,0 +1,336 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QScopedPointer>
+#include <QStringList>
+#include <QThread>
+#include <QtEndian>
+
+#include <clocale>
+#include <cstdlib>
+
+#include "SegmentCodec.h"
+#include "SimplifyQt.h"
+#include "private/PathKernels.h"
+
+// Simplifies polylines in bulk:
+//
+//   simplify-cli --tolerance 1 strokes.csv > strokes.seg
+//   simplify-cli --input-format binary < strokes.bin > strokes.seg
+//
+// Polylines are read in batches of about --batch points and each batch is
+// fitted on every core, so memory depends on the batch, not on the input.
+// Timing and throughput go to standard error.
+
+static const char *usage =
+    "Input, from the files given or standard input:\n"
+    "  csv     one point per line, x and y separated by a comma, semicolon or\n"
+    "          white space; an empty line ends a polyline, # starts a comment.\n"
+    "  binary  per polyline a little-endian quint32 point count followed by\n"
+    "          that many x, y pairs of little-endian doubles.\n"
+    "\n"
+    "Output, per polyline in input order: a little-endian quint32 segment\n"
+    "count followed by the segments, each control1, control2 and end point as\n"
+    "x, y pairs of little-endian doubles (floats with --float). The handles\n"
+    "are relative to the end point, as in SimplifyQt::Segment; the first\n"
+    "segment ends at the start of the polyline and its control1 is zero.\n"
+    "\n"
+    "With --max-error, per polyline a little-endian quint32 byte count\n"
+    "followed by that many bytes of SimplifyQt::encodeSegments() instead.";
+
+// One polyline at a time from a device.
+class Input
+{
+public:
+    explicit Input(QIODevice *device)
+        : device(device) {
+    }
+    virtual ~Input() {}
+
+public:
+    // Appends the points of the next polyline; false at the end of the
+    // input or on an error, which error() then describes.
+    virtual bool next(QVector<QPointF> &points) = 0;
+
+    const QString &error() const { return message; }
+
+protected:
+    QIODevice *device;
+    QString    message;
+};
+
+class CsvInput : public Input
+{
+public:
+    explicit CsvInput(QIODevice *device)
+        : Input(device)
+        , line(0) {
+    }
+
+public:
+    bool next(QVector<QPointF> &points) Q_DECL_OVERRIDE
+    {
+        const int start = points.count();
+        for (;;) {
+            QByteArray text = device->readLine();
+            if (text.isEmpty())
+                break;
+            ++line;
+
+            // strtod() stops at the first character that is not part of the
+            // number; the C numeric locale is set in main().
+            const char *s = text.constData();
+            while ((*s == ' ') || (*s == '\t'))
+                ++s;
+            if (*s == '#')
+                continue;
+            if ((*s == '\r') || (*s == '\n') || (*s == 0)) {
+                if (points.count() > start)
+                    return true;
+                continue;
+            }
+
+            char *end = nullptr;
+            double x = std::strtod(s, &end);
+            bool ok = (end != s);
+            s = end;
+            while ((*s == ' ') || (*s == '\t') || (*s == ',') || (*s == ';'))
+                ++s;
+            double y = std::strtod(s, &end);
+            ok = ok && (end != s);
+            s = end;
+            while ((*s == ' ') || (*s == '\t') || (*s == '\r') || (*s == '\n'))
+                ++s;
+            if (!ok || (*s != 0)) {
+                message = QStringLiteral("line %1: expected x and y").arg(line);
+                return false;
+            }
+            points.append(QPointF(x, y));
+        }
+
+        return points.count() > start;
+    }
+
+private:
+    qint64 line;
+};
+
+class BinaryInput : public Input
+{
+public:
+    explicit BinaryInput(QIODevice *device)
+        : Input(device)
+        , stream(device) {
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    }
+
+public:
+    bool next(QVector<QPointF> &points) Q_DECL_OVERRIDE
+    {
+        char head[sizeof(quint32)];
+        int read = stream.readRawData(head, sizeof(head));
+        if (read == 0)
+            return false;
+        if (read != int(sizeof(head))) {
+            message = QStringLiteral("truncated point count");
+            return false;
+        }
+
+        // Points are appended as they come, a bad count cannot allocate
+        // more than the input holds.
+        const quint32 count = qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(head));
+        for (quint32 i = 0; (i < count) && (stream.status() == QDataStream::Ok); ++i) {
+            double x;
+            double y;
+            stream >> x >> y;
+            points.append(QPointF(x, y));
+        }
+        if (stream.status() != QDataStream::Ok) {
+            message = QStringLiteral("truncated polyline of %1 points").arg(count);
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    QDataStream stream;
+};
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    std::setlocale(LC_NUMERIC, "C");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Fits cubic Bezier curves to polylines.\n\n") + QLatin1String(usage));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("files"), QStringLiteral("Input files, standard input if none or -."), QStringLiteral("[files...]"));
+    QCommandLineOption toleranceOption(QStringLiteral("tolerance"), QStringLiteral("Fitting tolerance."), QStringLiteral("value"), QStringLiteral("2.5"));
+    QCommandLineOption threadsOption(QStringLiteral("threads"), QStringLiteral("Threads to fit on, 0 for one per core."), QStringLiteral("count"), QStringLiteral("0"));
+    QCommandLineOption formatOption(QStringLiteral("input-format"), QStringLiteral("csv or binary."), QStringLiteral("format"), QStringLiteral("csv"));
+    QCommandLineOption softwareOption(QStringLiteral("software"), QStringLiteral("Fit with simplifySw instead of simplifyIs."));
+    QCommandLineOption floatOption(QStringLiteral("float"), QStringLiteral("Write floats instead of doubles."));
+    QCommandLineOption maxErrorOption(QStringLiteral("max-error"), QStringLiteral("Write segments quantized to within this distance."), QStringLiteral("value"));
+    QCommandLineOption batchOption(QStringLiteral("batch"), QStringLiteral("Points to read before fitting."), QStringLiteral("count"), QStringLiteral("1048576"));
+    QCommandLineOption outputOption(QStringLiteral("output"), QStringLiteral("File to write, standard output if not given."), QStringLiteral("file"));
+    parser.addOptions({ toleranceOption, threadsOption, formatOption, softwareOption, floatOption, maxErrorOption, batchOption, outputOption });
+    parser.process(app);
+
+    bool ok = false;
+    const qreal tolerance = parser.value(toleranceOption).toDouble(&ok);
+    if (!ok || (tolerance <= 0)) {
+        qCritical("Invalid tolerance: %s", qPrintable(parser.value(toleranceOption)));
+        return 1;
+    }
+    int threadCount = parser.value(threadsOption).toInt(&ok);
+    if (!ok || (threadCount < 0)) {
+        qCritical("Invalid thread count: %s", qPrintable(parser.value(threadsOption)));
+        return 1;
+    }
+    if (threadCount == 0)
+        threadCount = QThread::idealThreadCount();
+    const int batchPoints = parser.value(batchOption).toInt(&ok);
+    if (!ok || (batchPoints < 1)) {
+        qCritical("Invalid batch size: %s", qPrintable(parser.value(batchOption)));
+        return 1;
+    }
+    const QString format = parser.value(formatOption);
+    if ((format != QLatin1String("csv")) && (format != QLatin1String("binary"))) {
+        qCritical("Unknown input format: %s", qPrintable(format));
+        return 1;
+    }
+    const bool software = parser.isSet(softwareOption);
+    const bool quantized = parser.isSet(maxErrorOption);
+    const qreal maxError = parser.value(maxErrorOption).toDouble(&ok);
+    if (quantized && (!ok || (maxError <= 0))) {
+        qCritical("Invalid maximum error: %s", qPrintable(parser.value(maxErrorOption)));
+        return 1;
+    }
+
+    QStringList files = parser.positionalArguments();
+    if (files.isEmpty())
+        files << QStringLiteral("-");
+
+    QFile output;
+    if (parser.isSet(outputOption)) {
+        output.setFileName(parser.value(outputOption));
+        if (!output.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qCritical("Cannot write %s", qPrintable(output.fileName()));
+            return 1;
+        }
+    } else if (!output.open(stdout, QIODevice::WriteOnly)) {
+        qCritical("Cannot write to standard output");
+        return 1;
+    }
+    const qint64 realSize = parser.isSet(floatOption) ? sizeof(float) : sizeof(double);
+    QDataStream out(&output);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out.setFloatingPointPrecision(parser.isSet(floatOption) ? QDataStream::SinglePrecision : QDataStream::DoublePrecision);
+
+    qint64 polylineCount = 0;
+    qint64 pointCount = 0;
+    qint64 segmentCount = 0;
+    qint64 byteCount = 0;
+    qint64 readTime = 0;
+    qint64 fitTime = 0;
+    qint64 writeTime = 0;
+    QElapsedTimer total;
+    QElapsedTimer timer;
+    total.start();
+
+    QVector<QPointF> points;
+    QVector<int> offsets;
+    points.reserve(batchPoints);
+    for (const QString &name : files) {
+        QFile file;
+        bool opened;
+        if (name == QLatin1String("-")) {
+            opened = file.open(stdin, QIODevice::ReadOnly);
+        } else {
+            file.setFileName(name);
+            opened = file.open(QIODevice::ReadOnly);
+        }
+        if (!opened) {
+            qCritical("Cannot read %s", qPrintable(name));
+            return 1;
+        }
+
+        QScopedPointer<Input> input;
+        if (format == QLatin1String("csv")) {
+            input.reset(new CsvInput(&file));
+        } else {
+            input.reset(new BinaryInput(&file));
+        }
+
+        for (;;) {
+            // Whole polylines only, so a batch may end up a bit larger than
+            // batchPoints.
+            timer.start();
+            points.clear();
+            offsets.clear();
+            offsets.append(0);
+            while ((points.count() < batchPoints) && input->next(points))
+                offsets.append(points.count());
+            readTime += timer.nsecsElapsed();
+            if (!input->error().isEmpty()) {
+                qCritical("%s: %s", qPrintable(name), qPrintable(input->error()));
+                return 1;
+            }
+            if (offsets.count() == 1)
+                break;
+
+            timer.start();
+            SimplifyQt::SegmentBatch batch = software ? SimplifyQt::simplifySwBatch(points, offsets, tolerance, threadCount)
+                                                      : SimplifyQt::simplifyIsBatch(points, offsets, tolerance, threadCount);
+            fitTime += timer.nsecsElapsed();
+
+            timer.start();
+            for (int i = 0; i + 1 < batch.offsets.count(); ++i) {
+                const int first = batch.offsets.at(i);
+                const int last = batch.offsets.at(i + 1);
+                if (quantized) {
+                    QByteArray data = SimplifyQt::encodeSegments(batch.segments.mid(first, last - first), maxError);
+                    if (data.isEmpty()) {
+                        qCritical("Cannot quantize polyline %lld to %g", polylineCount + i, maxError);
+                        return 1;
+                    }
+                    out << quint32(data.size());
+                    out.writeRawData(data.constData(), data.size());
+                    byteCount += qint64(sizeof(quint32)) + data.size();
+                } else {
+                    out << quint32(last - first);
+                    for (int j = first; j < last; ++j)
+                        out << batch.segments.at(j);
+                    byteCount += qint64(sizeof(quint32)) + (last - first) * 6 * realSize;
+                }
+            }
+            writeTime += timer.nsecsElapsed();
+
+            polylineCount += offsets.count() - 1;
+            pointCount += points.count();
+            segmentCount += batch.segments.count();
+        }
+    }
+
+    output.flush();
+    if (out.status() != QDataStream::Ok) {
+        qCritical("Cannot write %s", qPrintable(output.fileName()));
+        return 1;
+    }
+
+    const double seconds = total.nsecsElapsed() * 1e-9;
+    const double fitSeconds = fitTime * 1e-9;
+    qInfo("%lld polylines, %lld points, %lld segments, %lld bytes written",
+          polylineCount, pointCount, segmentCount, byteCount);
+    qInfo("read %.3f s, fit %.3f s, write %.3f s, total %.3f s",
+          readTime * 1e-9, fitSeconds, writeTime * 1e-9, seconds);
+    qInfo("%.0f points/s fitting, %.0f points/s overall, %d threads, %s kernels",
+          (fitSeconds > 0) ? (pointCount / fitSeconds) : 0.0, (seconds > 0) ? (pointCount / seconds) : 0.0,
+          threadCount, software ? "software" : SimplifyQt::bestPathKernels().name);
+
+    return 0;
+}
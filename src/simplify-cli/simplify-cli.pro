@@ -0,0 +1,12 @@
+QT -= gui
+
+TEMPLATE = app
+TARGET   = simplify-cli
+
+CONFIG += qt console warn_on
+CONFIG -= app_bundle
+
+SOURCES += \
+    main.cpp
+
+include(../simplify-qt/simplify-qt.pri)
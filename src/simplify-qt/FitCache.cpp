@@ -0,0 +1,360 @@
+#include "FitCache.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <cstring>
+
+namespace SimplifyQt {
+
+// class PointHash
+
+// xxHash64 over the bit patterns of the point values, x then y, as qreal:
+// four independent lanes, so it runs at memory speed.
+class PointHash
+{
+public:
+    PointHash()
+        : words(0)
+        , tail(nullptr)
+        , tailCount(0) {
+        lanes[0] = Prime1 + Prime2;
+        lanes[1] = Prime2;
+        lanes[2] = 0;
+        lanes[3] = 0 - Prime1;
+    }
+
+public:
+    static quint64 hash(const PointSpan &points)
+    {
+        PointHash hash;
+        if (points.isPoints()) {
+            hash.add(reinterpret_cast<const qreal *>(points.points()), 2 * points.count());
+            return hash.finish();
+        }
+
+        // Other layouts are gathered into qreal pairs, the hash is the one of
+        // the same points as QPointF.
+        qreal buffer[2 * Gather];
+        for (int i = 0; i < points.count(); i += Gather) {
+            int n = qMin(int(Gather), points.count() - i);
+            for (int j = 0; j < n; ++j) {
+                QPointF point = points.at(i + j);
+                buffer[2 * j] = point.x();
+                buffer[2 * j + 1] = point.y();
+            }
+            hash.add(buffer, 2 * n);
+        }
+
+        return hash.finish();
+    }
+
+private:
+    enum { Gather = 256 };
+
+    static const quint64 Prime1 = Q_UINT64_C(0x9E3779B185EBCA87);
+    static const quint64 Prime2 = Q_UINT64_C(0xC2B2AE3D27D4EB4F);
+    static const quint64 Prime3 = Q_UINT64_C(0x165667B19E3779F9);
+    static const quint64 Prime4 = Q_UINT64_C(0x85EBCA77C2B2AE63);
+    static const quint64 Prime5 = Q_UINT64_C(0x27D4EB2F165667C5);
+
+    static inline quint64 rotl(quint64 x, int r)
+    {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    static inline quint64 round(quint64 lane, quint64 word)
+    {
+        return rotl(lane + word * Prime2, 31) * Prime1;
+    }
+
+    static inline quint64 merge(quint64 h, quint64 lane)
+    {
+        return (h ^ round(0, lane)) * Prime1 + Prime4;
+    }
+
+    static inline quint64 word(const qreal *value)
+    {
+        quint64 w;
+        memcpy(&w, value, sizeof(w));
+        return w;
+    }
+
+    void add(const qreal *values, int count)
+    {
+        // Only the last call may leave a partial block, the gather above
+        // always hands over whole ones before it.
+        int i = 0;
+        for (; i + 3 < count; i += 4) {
+            lanes[0] = round(lanes[0], word(values + i));
+            lanes[1] = round(lanes[1], word(values + i + 1));
+            lanes[2] = round(lanes[2], word(values + i + 2));
+            lanes[3] = round(lanes[3], word(values + i + 3));
+        }
+        tail = values + i;
+        tailCount = count - i;
+        words += quint64(count);
+    }
+
+    quint64 finish() const
+    {
+        quint64 h;
+        if (words >= 4) {
+            h = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+            for (int k = 0; k < 4; ++k) {
+                h = merge(h, lanes[k]);
+            }
+        } else {
+            h = Prime5;
+        }
+
+        h += words * sizeof(qreal);
+        for (int i = 0; i < tailCount; ++i) {
+            h ^= round(0, word(tail + i));
+            h = rotl(h, 27) * Prime1 + Prime4;
+        }
+
+        h ^= h >> 33;
+        h *= Prime2;
+        h ^= h >> 29;
+        h *= Prime3;
+        h ^= h >> 32;
+        return h;
+    }
+
+private:
+    quint64      lanes[4];
+    quint64      words;
+    const qreal *tail;
+    int          tailCount;
+}; // class PointHash
+
+// class FitCachePrivate
+
+struct FitCacheKey
+{
+    quint64 hash;
+    int     count;
+    int     fitter;
+    qreal   tolerance;
+
+    inline bool operator==(const FitCacheKey &other) const
+    {
+        return (hash == other.hash) && (count == other.count)
+                && (fitter == other.fitter) && (tolerance == other.tolerance);
+    }
+};
+
+inline uint qHash(const FitCacheKey &key, uint seed = 0)
+{
+    // The point hash is already well mixed.
+    return uint(key.hash ^ (key.hash >> 32)) ^ ::qHash(key.tolerance, seed) ^ uint(key.fitter);
+}
+
+class FitCachePrivate
+{
+public:
+    enum Fitter
+    {
+        Is,
+        Sw
+    };
+
+    struct Entry
+    {
+        FitCacheKey      key;
+        QVector<Segment> segments;
+        qint64           bytes;
+        Entry           *prev;
+        Entry           *next;
+    };
+
+    explicit FitCachePrivate(qint64 maxBytes)
+        : maxBytes(qMax(maxBytes, qint64(0)))
+        , bytes(0)
+        , hits(0)
+        , misses(0)
+        , evictions(0)
+        , head(nullptr)
+        , tail(nullptr) {
+    }
+
+    ~FitCachePrivate()
+    {
+        clear();
+    }
+
+public:
+    template <typename Simplify>
+    QVector<Segment> fit(Fitter fitter, const PointSpan &points, qreal tolerance, Simplify simplify)
+    {
+        FitCacheKey key = { PointHash::hash(points), points.count(), fitter, tolerance };
+
+        {
+            QMutexLocker locker(&mutex);
+            if (Entry *entry = index.value(key, nullptr)) {
+                ++hits;
+                unlink(entry);
+                link(entry);
+                return entry->segments;
+            }
+            ++misses;
+        }
+
+        // Fitted without the lock; a thread that missed the same key at the
+        // same time finds it cached and keeps the first copy.
+        QVector<Segment> segments = simplify(points, tolerance);
+        qint64 size = qint64(sizeof(Entry)) + qint64(segments.capacity()) * qint64(sizeof(Segment));
+
+        QMutexLocker locker(&mutex);
+        if ((size > maxBytes) || index.contains(key))
+            return segments;
+
+        Entry *entry = new Entry { key, segments, size, nullptr, nullptr };
+        index.insert(key, entry);
+        link(entry);
+        bytes += size;
+        trim();
+
+        return segments;
+    }
+
+    void clear()
+    {
+        while (head) {
+            Entry *next = head->next;
+            delete head;
+            head = next;
+        }
+        tail = nullptr;
+        index.clear();
+        bytes = 0;
+    }
+
+    void trim()
+    {
+        // Least recently used first, from the tail.
+        while (tail && (bytes > maxBytes)) {
+            Entry *entry = tail;
+            unlink(entry);
+            index.remove(entry->key);
+            bytes -= entry->bytes;
+            ++evictions;
+            delete entry;
+        }
+    }
+
+    void link(Entry *entry)
+    {
+        entry->prev = nullptr;
+        entry->next = head;
+        if (head)
+            head->prev = entry;
+        head = entry;
+        if (!tail)
+            tail = entry;
+    }
+
+    void unlink(Entry *entry)
+    {
+        if (entry->prev)
+            entry->prev->next = entry->next;
+        else
+            head = entry->next;
+        if (entry->next)
+            entry->next->prev = entry->prev;
+        else
+            tail = entry->prev;
+    }
+
+public:
+    mutable QMutex mutex;
+
+    qint64  maxBytes;
+    qint64  bytes;
+    quint64 hits;
+    quint64 misses;
+    quint64 evictions;
+
+    QHash<FitCacheKey, Entry *> index;
+    Entry *head;
+    Entry *tail;
+};
+
+// class FitCache
+
+FitCache::FitCache(qint64 maxBytes)
+    : d(new FitCachePrivate(maxBytes))
+{
+}
+
+FitCache::~FitCache()
+{
+    delete d;
+}
+
+QVector<Segment> FitCache::simplifyIs(const PointSpan &points, qreal tolerance)
+{
+    return d->fit(FitCachePrivate::Is, points, tolerance, [](const PointSpan &points, qreal tolerance) {
+        return SimplifyQt::simplifyIs(points, tolerance);
+    });
+}
+
+QVector<Segment> FitCache::simplifySw(const PointSpan &points, qreal tolerance)
+{
+    return d->fit(FitCachePrivate::Sw, points, tolerance, [](const PointSpan &points, qreal tolerance) {
+        return SimplifyQt::simplifySw(points, tolerance);
+    });
+}
+
+void FitCache::clear()
+{
+    QMutexLocker locker(&d->mutex);
+    d->clear();
+}
+
+qint64 FitCache::maxBytes() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->maxBytes;
+}
+
+void FitCache::setMaxBytes(qint64 maxBytes)
+{
+    QMutexLocker locker(&d->mutex);
+    d->maxBytes = qMax(maxBytes, qint64(0));
+    d->trim();
+}
+
+qint64 FitCache::bytes() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->bytes;
+}
+
+int FitCache::count() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->index.count();
+}
+
+quint64 FitCache::hits() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->hits;
+}
+
+quint64 FitCache::misses() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->misses;
+}
+
+quint64 FitCache::evictions() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->evictions;
+}
+
+} // namespace SimplifyQt
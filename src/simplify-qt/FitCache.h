@@ -0,0 +1,52 @@
+#ifndef FITCACHE_H
+#define FITCACHE_H
+
+#include "SimplifyQt.h"
+
+namespace SimplifyQt {
+
+class FitCachePrivate;
+
+// Remembers fitted segments by what they were fitted from: a 64-bit hash of
+// the point values, the point count, the tolerance and the fitter. The same
+// points give the same key whatever PointSpan layout they come in. Equal
+// keys are trusted, the points are not kept to compare.
+//
+// The least recently used results are dropped once the segments held take
+// more than maxBytes. A hit costs the hash, a lock and a shallow QVector
+// copy; fits run outside the lock, so any number of threads can share one
+// cache.
+class FitCache
+{
+public:
+    explicit FitCache(qint64 maxBytes = 64 * 1024 * 1024);
+    ~FitCache();
+
+public:
+    QVector<Segment> simplifyIs(const PointSpan &points, qreal tolerance = 2.5);
+    QVector<Segment> simplifySw(const PointSpan &points, qreal tolerance = 2.5);
+
+    void clear();
+
+public:
+    qint64 maxBytes() const;
+    void setMaxBytes(qint64 maxBytes);
+
+    // Bytes of the segments held, and how many results that is.
+    qint64 bytes() const;
+    int count() const;
+
+    // Counters since construction, clear() leaves them alone.
+    quint64 hits() const;
+    quint64 misses() const;
+    quint64 evictions() const;
+
+private:
+    Q_DISABLE_COPY(FitCache)
+
+    FitCachePrivate *d;
+}; // class FitCache
+
+} // namespace SimplifyQt
+
+#endif // FITCACHE_H
@@ -0,0 +1,36 @@
+#ifndef PAINTERPATHSINK_H
+#define PAINTERPATHSINK_H
+
+#include <QPainterPath>
+
+#include "SimplifyQt.h"
+
+namespace SimplifyQt {
+
+// Fits straight into a QPainterPath. Header only, so the library itself does
+// not need QtGui.
+class PainterPathSink : public CurveSink
+{
+public:
+    explicit PainterPathSink(QPainterPath &path)
+        : path(path) {
+    }
+
+public:
+    void moveTo(const QPointF &point) Q_DECL_OVERRIDE
+    {
+        path.moveTo(point);
+    }
+
+    void cubicTo(const QPointF &control1, const QPointF &control2, const QPointF &endPoint) Q_DECL_OVERRIDE
+    {
+        path.cubicTo(control1, control2, endPoint);
+    }
+
+private:
+    QPainterPath &path;
+}; // class PainterPathSink
+
+} // namespace SimplifyQt
+
+#endif // PAINTERPATHSINK_H
@@ -0,0 +1,226 @@
+#include "SegmentCodec.h"
+
+#include <QtEndian>
+
+#include <cmath>
+#include <cstring>
+
+namespace SimplifyQt {
+
+// class SegmentCodec
+
+// Encoding and decoding on raw buffers: the output is sized up front, grown
+// only when a segment might not fit, and written through a pointer, with no
+// per-value calls into a stream.
+class SegmentCodec
+{
+public:
+    enum { Version = 1 };
+
+    // A varint holds at most 64 bits, 7 per byte.
+    enum { MaxVarintBytes = 10 };
+    enum { MaxSegmentBytes = 6 * MaxVarintBytes };
+    enum { HeaderBytes = 1 + MaxVarintBytes + sizeof(quint64) };
+
+    // Room left for one segment is checked before each, the buffer starts
+    // at a typical size and doubles up to what a QByteArray can hold.
+    enum { TypicalSegmentBytes = 12 };
+    enum { MaxBytes = 0x7fffff00 };
+
+    // Grid positions stay exact in a double, and their differences in a
+    // qint64.
+    static inline qreal maxSteps()
+    {
+        return qreal(Q_INT64_C(1) << 52);
+    }
+
+public:
+    static bool encode(const QVector<Segment> &segments, qreal maxError, QByteArray &data)
+    {
+        // The step is stored as a double whatever qreal is.
+        const double step = 2 * maxError;
+        if (!(maxError > 0) || !std::isfinite(step))
+            return false;
+        const Grid grid = { step, 1 / step, maxError };
+
+        data.resize(int(qMin(qint64(HeaderBytes) + qint64(segments.count()) * TypicalSegmentBytes + MaxSegmentBytes, qint64(MaxBytes))));
+        char *out = data.data();
+        *out++ = char(Version);
+        out = putVarint(out, quint64(segments.count()));
+        quint64 bits;
+        memcpy(&bits, &step, sizeof(bits));
+        qToLittleEndian<quint64>(bits, reinterpret_cast<uchar *>(out));
+        out += sizeof(bits);
+
+        qint64 x = 0;
+        qint64 y = 0;
+        for (const Segment &segment : segments) {
+            const QPointF &end = segment.endPoint();
+            qint64 endX;
+            qint64 endY;
+            if (!quantize(grid, end.x(), 0, &endX) || !quantize(grid, end.y(), 0, &endY))
+                return false;
+
+            // Handles are rounded so that the decoded absolute points, the
+            // decoded end point plus the decoded handle, land close.
+            const qreal baseX = qreal(endX) * step;
+            const qreal baseY = qreal(endY) * step;
+            const QPointF control1 = end + segment.control1();
+            const QPointF control2 = end + segment.control2();
+            qint64 steps[4];
+            if (!quantize(grid, control1.x(), baseX, steps + 0) || !quantize(grid, control1.y(), baseY, steps + 1)
+                || !quantize(grid, control2.x(), baseX, steps + 2) || !quantize(grid, control2.y(), baseY, steps + 3)) {
+                return false;
+            }
+
+            const qint64 used = out - data.constData();
+            if (data.size() - used < MaxSegmentBytes) {
+                const qint64 size = qMin(2 * qint64(data.size()), qint64(MaxBytes));
+                if (size - used < MaxSegmentBytes)
+                    return false;
+                data.resize(int(size));
+                out = data.data() + used;
+            }
+
+            out = putVarint(out, zigZag(endX - x));
+            out = putVarint(out, zigZag(endY - y));
+            for (int i = 0; i < 4; ++i)
+                out = putVarint(out, zigZag(steps[i]));
+            x = endX;
+            y = endY;
+        }
+
+        data.resize(int(out - data.constData()));
+        data.squeeze();
+        return true;
+    }
+
+    static bool decode(const QByteArray &data, QVector<Segment> &segments)
+    {
+        const uchar *in = reinterpret_cast<const uchar *>(data.constData());
+        const uchar *end = in + data.size();
+
+        quint64 count;
+        if ((in == end) || (*in++ != Version) || !getVarint(in, end, &count))
+            return false;
+        if (end - in < qptrdiff(sizeof(quint64)))
+            return false;
+        const quint64 bits = qFromLittleEndian<quint64>(in);
+        in += sizeof(quint64);
+        double step;
+        memcpy(&step, &bits, sizeof(step));
+        if (!(step > 0) || !std::isfinite(step))
+            return false;
+
+        // Every segment takes at least six bytes, a count beyond what is
+        // left is corrupt and must not be allocated.
+        if (count > quint64(end - in) / 6)
+            return false;
+
+        segments.resize(int(count));
+        Segment *segment = segments.data();
+        qint64 x = 0;
+        qint64 y = 0;
+        for (quint64 i = 0; i < count; ++i, ++segment) {
+            quint64 values[6];
+            for (int k = 0; k < 6; ++k) {
+                if (!getVarint(in, end, values + k))
+                    return false;
+            }
+
+            x += unZigZag(values[0]);
+            y += unZigZag(values[1]);
+            segment->setEndPoint(QPointF(qreal(x) * step, qreal(y) * step));
+            segment->setControl1(QPointF(qreal(unZigZag(values[2])) * step, qreal(unZigZag(values[3])) * step));
+            segment->setControl2(QPointF(qreal(unZigZag(values[4])) * step, qreal(unZigZag(values[5])) * step));
+        }
+
+        return in == end;
+    }
+
+private:
+    struct Grid
+    {
+        qreal step;
+        qreal inverse;
+        qreal maxError;
+    };
+
+    // The grid steps from base that bring value within maxError, checked
+    // with the arithmetic of decode(), rounding included; the guess may be
+    // off by one, it comes from a multiplication instead of a division.
+    static inline bool quantize(const Grid &grid, qreal value, qreal base, qint64 *steps)
+    {
+        const qreal r = (value - base) * grid.inverse;
+        if (!(std::abs(r) < maxSteps()))
+            return false;
+
+        const qint64 nearest = qint64(std::floor(r + 0.5));
+        for (qint64 n : { nearest, nearest - 1, nearest + 1 }) {
+            if (std::abs((base + qreal(n) * grid.step) - value) <= grid.maxError) {
+                *steps = n;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    static inline quint64 zigZag(qint64 value)
+    {
+        return (quint64(value) << 1) ^ quint64(value >> 63);
+    }
+
+    static inline qint64 unZigZag(quint64 value)
+    {
+        return qint64(value >> 1) ^ -qint64(value & 1);
+    }
+
+    static inline char *putVarint(char *out, quint64 value)
+    {
+        while (value >= 0x80) {
+            *out++ = char(value | 0x80);
+            value >>= 7;
+        }
+        *out++ = char(value);
+        return out;
+    }
+
+    static inline bool getVarint(const uchar *&in, const uchar *end, quint64 *value)
+    {
+        quint64 result = 0;
+        for (int shift = 0; (shift < 64) && (in != end); shift += 7) {
+            const uchar byte = *in++;
+            result |= quint64(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                *value = result;
+                return true;
+            }
+        }
+
+        return false;
+    }
+}; // class SegmentCodec
+
+QByteArray encodeSegments(const QVector<Segment> &segments, qreal maxError)
+{
+    QByteArray data;
+    if (!SegmentCodec::encode(segments, maxError, data))
+        data.clear();
+
+    return data;
+}
+
+QVector<Segment> decodeSegments(const QByteArray &data, bool *ok)
+{
+    QVector<Segment> segments;
+    const bool valid = SegmentCodec::decode(data, segments);
+    if (!valid)
+        segments.clear();
+    if (ok)
+        *ok = valid;
+
+    return segments;
+}
+
+} // namespace SimplifyQt
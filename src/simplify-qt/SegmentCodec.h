@@ -0,0 +1,33 @@
+#ifndef SEGMENTCODEC_H
+#define SEGMENTCODEC_H
+
+#include <QByteArray>
+
+#include "SimplifyQt.h"
+
+namespace SimplifyQt {
+
+// Packs segments into a few bytes each for storage and transfer. End points
+// and the absolute control points (end point plus handle) are rounded to a
+// grid of 2 * maxError and come back within maxError of the originals in x
+// and y, so every point of every curve does too; a handle on its own may be
+// off by twice that. End points are stored as the grid steps from the one
+// before and handles as the steps from their end point, both zig-zag
+// varints, so a segment of a fitted polyline takes 6 to 20 bytes instead
+// of the 48 of Segment::save().
+//
+// The format is a version byte, the segment count as a varint and the grid
+// step as a little-endian double, followed by six varints per segment: end
+// point, control1 and control2, x then y.
+
+// Empty if maxError is not positive, a coordinate is not finite, the points
+// are too far from the origin for the grid to hold them, or the encoding
+// would not fit in a QByteArray.
+QByteArray encodeSegments(const QVector<Segment> &segments, qreal maxError);
+
+// Empty, and ok set to false, if data is not a whole encoding.
+QVector<Segment> decodeSegments(const QByteArray &data, bool *ok = nullptr);
+
+} // namespace SimplifyQt
+
+#endif // SEGMENTCODEC_H
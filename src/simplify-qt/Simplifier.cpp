@@ -0,0 +1,80 @@
+#include "Simplifier.h"
+
+#include "private/PathFitterIs.h"
+#include "private/PathKernels.h"
+
+namespace SimplifyQt {
+
+// class SimplifierPrivate
+
+class SimplifierPrivate
+{
+public:
+    explicit SimplifierPrivate(qreal tolerance)
+        : tolerance(tolerance)
+        , capacity(0)
+        , fitter(bestPathKernels()) {
+    }
+
+public:
+    void reserve(int count)
+    {
+        // Every curve covers at least one edge, so count segments suffice.
+        if (count > capacity) {
+            fitter.reserve(count);
+            segments.reserve(count);
+            capacity = count;
+        }
+    }
+
+public:
+    qreal tolerance;
+    int   capacity;
+
+    PathFitterIs     fitter;
+    QVector<Segment> segments;
+}; // class SimplifierPrivate
+
+// class Simplifier
+
+Simplifier::Simplifier(qreal tolerance)
+    : d(new SimplifierPrivate(tolerance))
+{
+}
+
+Simplifier::~Simplifier()
+{
+    delete d;
+}
+
+void Simplifier::reserve(int count)
+{
+    d->reserve(count);
+}
+
+int Simplifier::capacity() const
+{
+    return d->capacity;
+}
+
+const QVector<Segment> &Simplifier::simplify(const PointSpan &points)
+{
+    d->reserve(points.count());
+    d->segments.clear();
+    d->fitter.setPoints(points);
+    d->fitter.fit(d->segments, d->tolerance);
+
+    return d->segments;
+}
+
+qreal Simplifier::tolerance() const
+{
+    return d->tolerance;
+}
+
+void Simplifier::setTolerance(qreal tolerance)
+{
+    d->tolerance = tolerance;
+}
+
+} // namespace SimplifyQt
@@ -0,0 +1,43 @@
+#ifndef SIMPLIFIER_H
+#define SIMPLIFIER_H
+
+#include "SimplifyQt.h"
+
+namespace SimplifyQt {
+
+class SimplifierPrivate;
+
+// simplifyIs() for callers that fit again and again, such as a stroke
+// redrawn on every frame. The point arrays, the parameter buffers, the span
+// stack and the segments are kept from one call to the next and only grow,
+// so once they have reached the largest polyline seen - or the count given
+// to reserve() - a call does not touch the heap at all.
+//
+// The segments are those of simplifyIs() bit for bit. simplify() returns
+// the simplifier's own vector, valid until the next call; keeping a copy of
+// it makes that call allocate a new one.
+class Simplifier
+{
+public:
+    explicit Simplifier(qreal tolerance = 2.5);
+    ~Simplifier();
+
+public:
+    // Makes room for polylines of up to count points.
+    void reserve(int count);
+    int capacity() const;
+
+    const QVector<Segment> &simplify(const PointSpan &points);
+
+    qreal tolerance() const;
+    void setTolerance(qreal tolerance);
+
+private:
+    Q_DISABLE_COPY(Simplifier)
+
+    SimplifierPrivate *d;
+}; // class Simplifier
+
+} // namespace SimplifyQt
+
+#endif // SIMPLIFIER_H
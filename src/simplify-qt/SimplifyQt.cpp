@@ -1,13 +1,55 @@
 #include "SimplifyQt.h"
 
+#include <limits>
+
+#include "private/BatchFit.h"
+#include "private/Corners.h"
+#include "private/Decimation.h"
+#include "private/FitStatsCollector.h"
+#include "private/LevelFit.h"
 #include "private/PathFitterIs.h"
 #include "private/PathFitterSw.h"
+#include "private/PathKernels.h"
+#include "private/ParallelFit.h"
+#include "private/WindowedFit.h"
 
 namespace SimplifyQt {
 
+// class CubicArraySink
+
+template <typename T>
+class CubicArraySink : public CurveSink
+{
+public:
+    explicit CubicArraySink(QVector<T> &cubics, int count)
+        : cubics(cubics) {
+        // Six values per curve and two for the first point, counted in
+        // 64 bits; the vector grows past the estimate if it has to.
+        const qint64 size = qint64(cubics.count()) + 2 + 6 * qint64(SimplifyQt::segmentEstimate(count));
+        if (size <= qint64(std::numeric_limits<int>::max() / int(sizeof(T))))
+            cubics.reserve(int(size));
+    }
+
+public:
+    void moveTo(const QPointF &point) Q_DECL_OVERRIDE
+    {
+        cubics << T(point.x()) << T(point.y());
+    }
+
+    void cubicTo(const QPointF &control1, const QPointF &control2, const QPointF &endPoint) Q_DECL_OVERRIDE
+    {
+        cubics << T(control1.x()) << T(control1.y())
+               << T(control2.x()) << T(control2.y())
+               << T(endPoint.x()) << T(endPoint.y());
+    }
+
+private:
+    QVector<T> &cubics;
+}; // class CubicArraySink
+
 QVector<Segment> simplifyIs(const QVector<QPointF> &points, qreal tolerance)
 {
-    return SimplifyQt::PathFitterIs(points).fit(tolerance);
+    return SimplifyQt::PathFitterIs(points, bestPathKernels()).fit(tolerance);
 }
 
 QVector<Segment> simplifySw(const QVector<QPointF> &points, qreal tolerance)
@@ -15,4 +57,186 @@ QVector<Segment> simplifySw(const QVector<QPointF> &points, qreal tolerance)
     return SimplifyQt::PathFitterSw(points).fit(tolerance);
 }
 
+QVector<Segment> simplifyIs(const PointSpan &points, qreal tolerance)
+{
+    return SimplifyQt::PathFitterIs(points, bestPathKernels()).fit(tolerance);
+}
+
+QVector<Segment> simplifySw(const PointSpan &points, qreal tolerance)
+{
+    return SimplifyQt::PathFitterSw(points).fit(tolerance);
+}
+
+QVector<Segment> simplifyIs(const PointSpan &points, FitStats &stats, qreal tolerance)
+{
+    QVector<Segment> segments;
+    segments.reserve(SimplifyQt::segmentEstimate(points.count()));
+    SimplifyQt::FitStatsCollector collector(stats);
+    SimplifyQt::PathFitterIs(points, bestPathKernels()).fit(segments, tolerance, collector);
+    return segments;
+}
+
+QVector<Segment> simplifySw(const PointSpan &points, FitStats &stats, qreal tolerance)
+{
+    QVector<Segment> segments;
+    segments.reserve(SimplifyQt::segmentEstimate(points.count()));
+    SimplifyQt::FitStatsCollector collector(stats);
+    SimplifyQt::PathFitterSw(points).fit(segments, tolerance, collector);
+    return segments;
+}
+
+QVector<QVector<Segment> > simplifyIsLevels(const PointSpan &points, const QVector<qreal> &tolerances)
+{
+    SimplifyQt::PathFitterIs fitter(points, bestPathKernels());
+    return SimplifyQt::LevelFit<SimplifyQt::PathFitterIs>(fitter).fit(tolerances);
+}
+
+QVector<QVector<Segment> > simplifySwLevels(const PointSpan &points, const QVector<qreal> &tolerances)
+{
+    SimplifyQt::PathFitterSw fitter(points);
+    return SimplifyQt::LevelFit<SimplifyQt::PathFitterSw>(fitter).fit(tolerances);
+}
+
+QVector<Segment> simplifyIsDecimated(const PointSpan &points, qreal tolerance, qreal fraction)
+{
+    SimplifyQt::Decimation decimation(points, tolerance, fraction);
+    return SimplifyQt::PathFitterIs(decimation.points, bestPathKernels()).fit(decimation.tolerance);
+}
+
+QVector<Segment> simplifySwDecimated(const PointSpan &points, qreal tolerance, qreal fraction)
+{
+    SimplifyQt::Decimation decimation(points, tolerance, fraction);
+    return SimplifyQt::PathFitterSw(decimation.points).fit(decimation.tolerance);
+}
+
+QVector<Segment> simplifyIsFloat(const PointSpan &points, qreal tolerance)
+{
+#if !defined(QT_COORD_TYPE)
+    return SimplifyQt::PathFitterIsF(points, bestPathKernelsF()).fit(tolerance);
+#else
+    // qreal is float already.
+    return SimplifyQt::PathFitterIs(points, bestPathKernels()).fit(tolerance);
+#endif
+}
+
+QVector<Segment> simplifyIsBalanced(const PointSpan &points, qreal tolerance)
+{
+    SimplifyQt::PathFitterIs fitter(points, bestPathKernels());
+    fitter.setBalanced(true);
+    return fitter.fit(tolerance);
+}
+
+QVector<Segment> simplifySwBalanced(const PointSpan &points, qreal tolerance)
+{
+    SimplifyQt::PathFitterSw fitter(points);
+    fitter.setBalanced(true);
+    return fitter.fit(tolerance);
+}
+
+void simplifyIs(const PointSpan &points, CurveSink &sink, qreal tolerance)
+{
+    SimplifyQt::PathFitterIs(points, bestPathKernels()).fit(sink, tolerance);
+}
+
+void simplifySw(const PointSpan &points, CurveSink &sink, qreal tolerance)
+{
+    SimplifyQt::PathFitterSw(points).fit(sink, tolerance);
+}
+
+void simplifyIs(const PointSpan &points, QVector<qreal> &cubics, qreal tolerance)
+{
+    CubicArraySink<qreal> sink(cubics, points.count());
+    SimplifyQt::PathFitterIs(points, bestPathKernels()).fit(sink, tolerance);
+}
+
+void simplifySw(const PointSpan &points, QVector<qreal> &cubics, qreal tolerance)
+{
+    CubicArraySink<qreal> sink(cubics, points.count());
+    SimplifyQt::PathFitterSw(points).fit(sink, tolerance);
+}
+
+#if !defined(QT_COORD_TYPE)
+void simplifyIs(const PointSpan &points, QVector<float> &cubics, qreal tolerance)
+{
+    CubicArraySink<float> sink(cubics, points.count());
+    SimplifyQt::PathFitterIs(points, bestPathKernels()).fit(sink, tolerance);
+}
+
+void simplifySw(const PointSpan &points, QVector<float> &cubics, qreal tolerance)
+{
+    CubicArraySink<float> sink(cubics, points.count());
+    SimplifyQt::PathFitterSw(points).fit(sink, tolerance);
+}
+#endif
+
+QVector<Segment> simplifyIsParallel(const QVector<QPointF> &points, qreal tolerance, int threadCount)
+{
+    SimplifyQt::PathFitterIs fitter(points, bestPathKernels());
+    return SimplifyQt::ParallelFit<SimplifyQt::PathFitterIs>(fitter, threadCount).fit(tolerance);
+}
+
+QVector<Segment> simplifySwParallel(const QVector<QPointF> &points, qreal tolerance, int threadCount)
+{
+    SimplifyQt::PathFitterSw fitter(points);
+    return SimplifyQt::ParallelFit<SimplifyQt::PathFitterSw>(fitter, threadCount).fit(tolerance);
+}
+
+QVector<Segment> simplifyIsCorners(const PointSpan &points, qreal tolerance, qreal cornerAngle, int threadCount)
+{
+    SimplifyQt::PathFitterIs fitter(points, bestPathKernels());
+    SimplifyQt::Corners corners(fitter.path(), SimplifyQt::Corners::radius(tolerance), cornerAngle);
+    return SimplifyQt::ParallelFit<SimplifyQt::PathFitterIs>(fitter, threadCount).fit(tolerance, corners.indices);
+}
+
+QVector<Segment> simplifySwCorners(const PointSpan &points, qreal tolerance, qreal cornerAngle, int threadCount)
+{
+    SimplifyQt::PathFitterSw fitter(points);
+    SimplifyQt::Corners corners(fitter.path(), SimplifyQt::Corners::radius(tolerance), cornerAngle);
+    return SimplifyQt::ParallelFit<SimplifyQt::PathFitterSw>(fitter, threadCount).fit(tolerance, corners.indices);
+}
+
+void simplifyIsWindowed(const PointSpan &points, CurveSink &sink, qreal tolerance, int window)
+{
+    SimplifyQt::PathFitterIs fitter(bestPathKernels());
+    SimplifyQt::SpanSource source(points);
+    SimplifyQt::WindowedFit<SimplifyQt::PathFitterIs, SimplifyQt::SpanSource>(fitter, source, window).fit(sink, tolerance);
+}
+
+void simplifySwWindowed(const PointSpan &points, CurveSink &sink, qreal tolerance, int window)
+{
+    SimplifyQt::PathFitterSw fitter;
+    SimplifyQt::SpanSource source(points);
+    SimplifyQt::WindowedFit<SimplifyQt::PathFitterSw, SimplifyQt::SpanSource>(fitter, source, window).fit(sink, tolerance);
+}
+
+bool simplifyIsFile(const QString &fileName, CurveSink &sink, qreal tolerance, int window)
+{
+    SimplifyQt::MappedPointFile file(fileName);
+    if (!file.open())
+        return false;
+
+    SimplifyQt::PathFitterIs fitter(bestPathKernels());
+    return SimplifyQt::WindowedFit<SimplifyQt::PathFitterIs, SimplifyQt::MappedPointFile>(fitter, file, window).fit(sink, tolerance);
+}
+
+SegmentBatch simplifyIsBatch(const QVector<QVector<QPointF> > &polylines, qreal tolerance, int threadCount)
+{
+    return SimplifyQt::BatchFit<SimplifyQt::PathFitterIs>(threadCount).fit(polylines, tolerance);
+}
+
+SegmentBatch simplifySwBatch(const QVector<QVector<QPointF> > &polylines, qreal tolerance, int threadCount)
+{
+    return SimplifyQt::BatchFit<SimplifyQt::PathFitterSw>(threadCount).fit(polylines, tolerance);
+}
+
+SegmentBatch simplifyIsBatch(const QVector<QPointF> &points, const QVector<int> &offsets, qreal tolerance, int threadCount)
+{
+    return SimplifyQt::BatchFit<SimplifyQt::PathFitterIs>(threadCount).fit(points, offsets, tolerance);
+}
+
+SegmentBatch simplifySwBatch(const QVector<QPointF> &points, const QVector<int> &offsets, qreal tolerance, int threadCount)
+{
+    return SimplifyQt::BatchFit<SimplifyQt::PathFitterSw>(threadCount).fit(points, offsets, tolerance);
+}
+
 } // namespace SimplifyQt
@@ -3,6 +3,7 @@
 
 #include <QVector>
 #include <QPointF>
+#include <QString>
 
 namespace SimplifyQt {
 
@@ -52,6 +53,102 @@ private:
     QPointF _endPoint;
 };
 
+// Read-only view of points in the caller's memory: QPointF arrays, separate
+// or interleaved x and y arrays of qreal or float, with a stride counted in
+// elements. Interleaved float pairs are PointSpan(xy, xy + 1, count, 2).
+// The memory has to stay valid for as long as the view is used.
+//
+// With Qt configured as -qreal float, qreal is float and the float
+// overloads here and below would repeat the qreal ones; they are left out.
+class PointSpan
+{
+public:
+    enum Type
+    {
+        Double,
+        Float
+    };
+
+public:
+    inline PointSpan(const QVector<QPointF> &points);
+    inline PointSpan(const QPointF *points, int count);
+    inline PointSpan(const qreal *x, const qreal *y, int count, int stride = 1);
+#if !defined(QT_COORD_TYPE)
+    inline PointSpan(const float *x, const float *y, int count, int stride = 1);
+#endif
+
+public:
+    inline Type type() const;
+    inline int count() const;
+    inline int stride() const;
+    inline const void *xData() const;
+    inline const void *yData() const;
+
+    // The points are a plain QPointF array, points() points to it.
+    inline bool isPoints() const;
+    inline const QPointF *points() const;
+
+    inline QPointF at(int i) const;
+
+    // The count points from first on, in the same memory.
+    inline PointSpan mid(int first, int count) const;
+
+private:
+    const void *_x;
+    const void *_y;
+    int         _count;
+    int         _stride;
+    Type        _type;
+};
+
+// Receives fitted curves with absolute control points, in order: moveTo()
+// once with the first point, then cubicTo() for every curve.
+class CurveSink
+{
+public:
+    virtual ~CurveSink() {}
+
+public:
+    virtual void moveTo(const QPointF &point) = 0;
+    virtual void cubicTo(const QPointF &control1, const QPointF &control2, const QPointF &endPoint) = 0;
+};
+
+// What one fit did, from the simplifyIs()/simplifySw() overloads that take
+// one. The segments are the same as without; fits that do not ask for it
+// are compiled without any of the counting.
+struct FitStats
+{
+    inline FitStats();
+
+    // Spans fitted or split, the calls of fitCubic() in PathFitter.js, and
+    // those of two points, fitted as a line.
+    int spans;
+    int lineSpans;
+
+    // Deepest split span; the whole polyline is depth 0.
+    int maxDepth;
+
+    // generateBezier()/findMaxError() rounds of all spans, and how many
+    // spans took i + 1 rounds at index i.
+    int iterations;
+    QVector<int> iterationHistogram;
+
+    int reparameterizeCalls;
+    qint64 findRootCalls;
+
+    // Rounds left because the error did not shrink.
+    int earlyBreaks;
+
+    // Index of the point every split was made at, in the order made.
+    QVector<int> splits;
+
+    // Time spent in each phase, in nanoseconds.
+    qint64 parameterizeTime;
+    qint64 generateBezierTime;
+    qint64 findMaxErrorTime;
+    qint64 reparameterizeTime;
+};
+
 /*****************************************************************************
   Segment inline functions
  *****************************************************************************/
@@ -191,9 +288,216 @@ inline void Segment::load(QDataStream &ds)
 
 #endif // QT_NO_DATASTREAM
 
+/*****************************************************************************
+  FitStats inline functions
+ *****************************************************************************/
+
+inline FitStats::FitStats()
+    : spans(0)
+    , lineSpans(0)
+    , maxDepth(0)
+    , iterations(0)
+    , reparameterizeCalls(0)
+    , findRootCalls(0)
+    , earlyBreaks(0)
+    , parameterizeTime(0)
+    , generateBezierTime(0)
+    , findMaxErrorTime(0)
+    , reparameterizeTime(0)
+{
+}
+
+/*****************************************************************************
+  PointSpan inline functions
+ *****************************************************************************/
+
+inline PointSpan::PointSpan(const QVector<QPointF> &points)
+    : _x(points.constData())
+    , _y(reinterpret_cast<const qreal *>(points.constData()) + 1)
+    , _count(points.count())
+    , _stride(2)
+    , _type(Double)
+{
+}
+
+inline PointSpan::PointSpan(const QPointF *points, int count)
+    : _x(points)
+    , _y(reinterpret_cast<const qreal *>(points) + 1)
+    , _count(count)
+    , _stride(2)
+    , _type(Double)
+{
+}
+
+inline PointSpan::PointSpan(const qreal *x, const qreal *y, int count, int stride)
+    : _x(x)
+    , _y(y)
+    , _count(count)
+    , _stride(stride)
+    , _type(Double)
+{
+}
+
+#if !defined(QT_COORD_TYPE)
+inline PointSpan::PointSpan(const float *x, const float *y, int count, int stride)
+    : _x(x)
+    , _y(y)
+    , _count(count)
+    , _stride(stride)
+    , _type(Float)
+{
+}
+#endif
+
+inline PointSpan::Type PointSpan::type() const
+{
+    return _type;
+}
+
+inline int PointSpan::count() const
+{
+    return _count;
+}
+
+inline int PointSpan::stride() const
+{
+    return _stride;
+}
+
+inline const void *PointSpan::xData() const
+{
+    return _x;
+}
+
+inline const void *PointSpan::yData() const
+{
+    return _y;
+}
+
+inline bool PointSpan::isPoints() const
+{
+    return (_type == Double) && (_stride == 2) && (_y == static_cast<const qreal *>(_x) + 1);
+}
+
+inline const QPointF *PointSpan::points() const
+{
+    return static_cast<const QPointF *>(_x);
+}
+
+inline QPointF PointSpan::at(int i) const
+{
+    if (_type == Float)
+        return QPointF(static_cast<const float *>(_x)[i * _stride], static_cast<const float *>(_y)[i * _stride]);
+    return QPointF(static_cast<const qreal *>(_x)[i * _stride], static_cast<const qreal *>(_y)[i * _stride]);
+}
+
+inline PointSpan PointSpan::mid(int first, int count) const
+{
+#if !defined(QT_COORD_TYPE)
+    if (_type == Float)
+        return PointSpan(static_cast<const float *>(_x) + first * _stride, static_cast<const float *>(_y) + first * _stride, count, _stride);
+#endif
+    return PointSpan(static_cast<const qreal *>(_x) + first * _stride, static_cast<const qreal *>(_y) + first * _stride, count, _stride);
+}
+
 QVector<Segment> simplifyIs(const QVector<QPointF> &points, qreal tolerance = 2.5);
 QVector<Segment> simplifySw(const QVector<QPointF> &points, qreal tolerance = 2.5);
 
+// Same as above for points read in place, with no QVector<QPointF> copy.
+QVector<Segment> simplifyIs(const PointSpan &points, qreal tolerance = 2.5);
+QVector<Segment> simplifySw(const PointSpan &points, qreal tolerance = 2.5);
+
+// The curves go straight to the sink, no Segment is built.
+void simplifyIs(const PointSpan &points, CurveSink &sink, qreal tolerance = 2.5);
+void simplifySw(const PointSpan &points, CurveSink &sink, qreal tolerance = 2.5);
+
+// Appends x and y of the first point to cubics, then control1, control2 and
+// the end point of every curve, six values each.
+void simplifyIs(const PointSpan &points, QVector<qreal> &cubics, qreal tolerance = 2.5);
+void simplifySw(const PointSpan &points, QVector<qreal> &cubics, qreal tolerance = 2.5);
+#if !defined(QT_COORD_TYPE)
+void simplifyIs(const PointSpan &points, QVector<float> &cubics, qreal tolerance = 2.5);
+void simplifySw(const PointSpan &points, QVector<float> &cubics, qreal tolerance = 2.5);
+#endif
+
+// The segments of simplifyIs()/simplifySw() at each of the tolerances, bit
+// for bit, in one walk over the points: they are loaded once, and every span
+// is fitted once for all the tolerances that reach it.
+QVector<QVector<Segment> > simplifyIsLevels(const PointSpan &points, const QVector<qreal> &tolerances);
+QVector<QVector<Segment> > simplifySwLevels(const PointSpan &points, const QVector<qreal> &tolerances);
+
+// Dense input first goes through a radial distance pass: points closer than
+// fraction * sqrt(tolerance) to the last kept one are dropped, the rest are
+// fitted with what is left of the tolerance. Every input point, dropped or
+// not, stays within the same distance of the curves as with simplifyIs().
+QVector<Segment> simplifyIsDecimated(const PointSpan &points, qreal tolerance = 2.5, qreal fraction = 0.25);
+QVector<Segment> simplifySwDecimated(const PointSpan &points, qreal tolerance = 2.5, qreal fraction = 0.25);
+
+// simplifyIs() with the points rounded to float after moving them next to
+// the first one: half the memory traffic and twice the lanes per kernel. The
+// curves still stay within tolerance of the points, not bit for bit the same
+// as simplifyIs().
+QVector<Segment> simplifyIsFloat(const PointSpan &points, qreal tolerance = 2.5);
+
+// simplifyIs()/simplifySw() splitting every span of 16 edges or more in its
+// middle half, at the point of largest error there is one, so no input
+// takes more than O(n log n): spikes next to the ends of spans, which make
+// the plain fit cut off a few points at a time, cost no more than any
+// other points. The curves stay within the tolerance but are not those of
+// simplifyIs(), and may be a few more.
+QVector<Segment> simplifyIsBalanced(const PointSpan &points, qreal tolerance = 2.5);
+QVector<Segment> simplifySwBalanced(const PointSpan &points, qreal tolerance = 2.5);
+
+// Same segments, adding to stats what it took to find them.
+QVector<Segment> simplifyIs(const PointSpan &points, FitStats &stats, qreal tolerance = 2.5);
+QVector<Segment> simplifySw(const PointSpan &points, FitStats &stats, qreal tolerance = 2.5);
+
+// Same result as simplifyIs()/simplifySw(), bit for bit, with independent
+// spans fitted on up to threadCount threads (0 means one per core).
+QVector<Segment> simplifyIsParallel(const QVector<QPointF> &points, qreal tolerance = 2.5, int threadCount = 0);
+QVector<Segment> simplifySwParallel(const QVector<QPointF> &points, qreal tolerance = 2.5, int threadCount = 0);
+
+// Splits the points first at corners, where the polyline turns by more than
+// cornerAngle degrees, and fits the pieces on their own, on up to
+// threadCount threads (0 means one per core). Corners come out sharp
+// instead of rounded, and the fit skips the rounds that would have found
+// them by failing. Turns are measured over twice the distance a point may
+// be off its curve, so noise does not count as a corner. The segments do not
+// depend on the thread count, but are not those of simplifyIs().
+QVector<Segment> simplifyIsCorners(const PointSpan &points, qreal tolerance = 2.5, qreal cornerAngle = 60, int threadCount = 0);
+QVector<Segment> simplifySwCorners(const PointSpan &points, qreal tolerance = 2.5, qreal cornerAngle = 60, int threadCount = 0);
+
+// Fits points a window of that many at a time and passes the curves to
+// sink as soon as they are final, so memory stays the same however many
+// points there are. Curves meet with the same tangent across windows and
+// stay within the tolerance, but do not split where simplifyIs() would.
+void simplifyIsWindowed(const PointSpan &points, CurveSink &sink, qreal tolerance = 2.5, int window = 65536);
+void simplifySwWindowed(const PointSpan &points, CurveSink &sink, qreal tolerance = 2.5, int window = 65536);
+
+// The same on a file of interleaved x and y doubles in native byte order,
+// the layout of a QPointF array, mapped one window at a time. Returns false
+// if the file cannot be read or is not a whole number of points; the sink
+// may have had curves by then.
+bool simplifyIsFile(const QString &fileName, CurveSink &sink, qreal tolerance = 2.5, int window = 65536);
+
+// Segments of many polylines in one buffer: those of polyline i are
+// segments[offsets[i]] up to segments[offsets[i + 1] - 1].
+struct SegmentBatch
+{
+    QVector<Segment> segments;
+    QVector<int>     offsets;
+};
+
+// Same segments as simplifyIs()/simplifySw() on every polyline, fitted on up
+// to threadCount threads (0 means one per core). The flat overloads take the
+// points of polyline i as points[offsets[i]] up to points[offsets[i + 1] - 1];
+// they return an empty batch unless offsets starts at 0, never decreases and
+// ends at most at points.count().
+SegmentBatch simplifyIsBatch(const QVector<QVector<QPointF> > &polylines, qreal tolerance = 2.5, int threadCount = 0);
+SegmentBatch simplifySwBatch(const QVector<QVector<QPointF> > &polylines, qreal tolerance = 2.5, int threadCount = 0);
+SegmentBatch simplifyIsBatch(const QVector<QPointF> &points, const QVector<int> &offsets, qreal tolerance = 2.5, int threadCount = 0);
+SegmentBatch simplifySwBatch(const QVector<QPointF> &points, const QVector<int> &offsets, qreal tolerance = 2.5, int threadCount = 0);
+
 } // namespace SimplifyQt
 
 Q_DECLARE_TYPEINFO(SimplifyQt::Segment, Q_MOVABLE_TYPE);
@@ -0,0 +1,208 @@
+#include "StreamingSimplifier.h"
+
+#include "private/FitSpan.h"
+#include "private/PathFitterIs.h"
+#include "private/PathKernels.h"
+
+namespace SimplifyQt {
+
+// class StreamingSimplifierPrivate
+
+class StreamingSimplifierPrivate
+{
+public:
+    StreamingSimplifierPrivate(qreal tolerance, int window)
+        : tolerance(tolerance)
+        , window(qMax(window, 1))
+        , committed(0)
+        , hasTangent(false)
+        , fitter(bestPathKernels()) {
+        // addPoint() leaves at most 4 * window + 1 points in the tail and
+        // adds one, addPoints() adds up to window at a time: the buffers
+        // for that many are the only ones refitting ever needs.
+        const int capacity = 5 * this->window + 2;
+        tail.reserve(capacity);
+        ends.reserve(capacity);
+        fitter.reserve(capacity);
+        scratch.arena.reserve(capacity);
+        scratch.spans.reserve(capacity);
+    }
+
+public:
+    void refit(bool final)
+    {
+        // The last committed segment is the anchor the tail starts at: its
+        // control2 belongs to the first curve of the tail and is rewritten
+        // by every refit.
+
+        segments.resize(committed);
+
+        int n = tail.count();
+        if (n == 0)
+            return;
+
+        if (committed == 0) {
+            segments.append(Segment(tail.first()));
+            committed = 1;
+        }
+        if (n == 1)
+            return;
+
+        fitter.setPoints(tail);
+        QPointF tan1 = hasTangent ? tangent : (tail.at(1) - tail.at(0));
+        QPointF tan2 = tail.at(n - 2) - tail.at(n - 1);
+        int first = 0;
+        int drop = 0;
+
+        if (!final && (n - 1 > 4 * window)) {
+            // One curve still covers the whole tail. Split it where the
+            // fitter would, with the tangent of the neighbouring points, and
+            // commit the part that is out of the window.
+            int split = n - 1 - window;
+            QPointF tanCenter = tail.at(split - 1) - tail.at(split + 1);
+            fit(FitSpan { 0, split, tan1, tanCenter });
+            committed = segments.count();
+            tan1 = tanCenter * -1;
+            tangent = tan1;
+            hasTangent = true;
+            first = drop = split;
+        }
+
+        ends.clear();
+        fit(FitSpan { first, n - 1, tan1, tan2 });
+
+        if (final) {
+            committed = segments.count();
+        } else {
+            int limit = n - 1 - window;
+            int c = 0;
+            while ((c < ends.count()) && (ends.at(c) <= limit))
+                ++c;
+            if (c > 0) {
+                int anchor = ends.at(c - 1);
+                committed += c;
+                tangent = tail.at(anchor + 1) - tail.at(anchor - 1);
+                hasTangent = true;
+                drop = anchor;
+            }
+        }
+
+        if (drop > 0)
+            tail.remove(0, drop);
+    }
+
+    void fit(FitSpan span)
+    {
+        // PathFitterIs::fitCubic(), noting the point each segment ends at.
+
+        QVector<FitSpan> &spans = scratch.spans;
+        spans.append(span);
+        while (!spans.isEmpty()) {
+            span = spans.last();
+            spans.removeLast();
+
+            FitSpan left;
+            FitSpan right;
+            if (fitter.fitSpan(scratch, segments, tolerance, span, &left, &right)) {
+                ends.append(span.last);
+            } else {
+                spans.append(right);
+                spans.append(left);
+            }
+        }
+    }
+
+    void clear()
+    {
+        tail.clear();
+        segments.clear();
+        ends.clear();
+        committed = 0;
+        hasTangent = false;
+    }
+
+public:
+    qreal tolerance;
+    int   window;
+
+    QVector<QPointF> tail;
+    QVector<Segment> segments;
+    QVector<int>     ends;
+    int              committed;
+
+    QPointF tangent;
+    bool    hasTangent;
+
+    PathFitterIs fitter;
+    FitScratch   scratch;
+}; // class StreamingSimplifierPrivate
+
+// class StreamingSimplifier
+
+StreamingSimplifier::StreamingSimplifier(qreal tolerance, int window)
+    : d(new StreamingSimplifierPrivate(tolerance, window))
+{
+}
+
+StreamingSimplifier::~StreamingSimplifier()
+{
+    delete d;
+}
+
+void StreamingSimplifier::addPoint(const QPointF &point)
+{
+    d->tail.append(point);
+    d->refit(false);
+}
+
+void StreamingSimplifier::addPoints(const QVector<QPointF> &points)
+{
+    // A window at a time, so a long batch never makes the tail long.
+    for (int i = 0; i < points.count(); i += d->window) {
+        int end = qMin(i + d->window, points.count());
+        for (int j = i; j < end; ++j)
+            d->tail.append(points.at(j));
+        d->refit(false);
+    }
+}
+
+QVector<Segment> StreamingSimplifier::finish()
+{
+    d->refit(true);
+    QVector<Segment> segments = d->segments;
+    d->clear();
+
+    return segments;
+}
+
+void StreamingSimplifier::reset()
+{
+    d->clear();
+}
+
+const QVector<Segment> &StreamingSimplifier::segments() const
+{
+    return d->segments;
+}
+
+int StreamingSimplifier::committedCount() const
+{
+    return d->committed;
+}
+
+int StreamingSimplifier::pendingCount() const
+{
+    return d->tail.count();
+}
+
+qreal StreamingSimplifier::tolerance() const
+{
+    return d->tolerance;
+}
+
+int StreamingSimplifier::window() const
+{
+    return d->window;
+}
+
+} // namespace SimplifyQt
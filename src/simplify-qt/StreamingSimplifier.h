@@ -0,0 +1,56 @@
+#ifndef STREAMINGSIMPLIFIER_H
+#define STREAMINGSIMPLIFIER_H
+
+#include "SimplifyQt.h"
+
+namespace SimplifyQt {
+
+class StreamingSimplifierPrivate;
+
+// Fits a polyline while it is still growing. Segments that end more than
+// window points before the newest point are committed and never refitted;
+// only the open tail behind the last committed segment is fitted again on
+// every call, and it never grows past about 4 * window points, so the cost
+// per point does not depend on the length of the stroke.
+//
+// Every committed curve was fitted to its own points with the same
+// tolerance, so the result is as close to the points as the one of
+// simplifyIs(), just not split at the same places.
+class StreamingSimplifier
+{
+public:
+    explicit StreamingSimplifier(qreal tolerance = 2.5, int window = 64);
+    ~StreamingSimplifier();
+
+public:
+    void addPoint(const QPointF &point);
+    void addPoints(const QVector<QPointF> &points);
+
+    // Fits the open tail for good, returns every segment of the stroke and
+    // makes the simplifier ready for the next one.
+    QVector<Segment> finish();
+    void reset();
+
+public:
+    // Committed segments followed by the current fit of the open tail.
+    const QVector<Segment> &segments() const;
+
+    // The first committedCount() segments keep their end point and control1
+    // for good, and all but the last of them keep control2, too.
+    int committedCount() const;
+
+    // Points behind the last committed segment that are fitted again.
+    int pendingCount() const;
+
+    qreal tolerance() const;
+    int window() const;
+
+private:
+    Q_DISABLE_COPY(StreamingSimplifier)
+
+    StreamingSimplifierPrivate *d;
+}; // class StreamingSimplifier
+
+} // namespace SimplifyQt
+
+#endif // STREAMINGSIMPLIFIER_H
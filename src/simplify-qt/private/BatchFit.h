@@ -0,0 +1,193 @@
+#ifndef BATCHFIT_H
+#define BATCHFIT_H
+
+#include "../SimplifyQt.h"
+
+#include <QAtomicInt>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+#include "FitSpan.h"
+
+namespace SimplifyQt {
+
+template <typename Fitter>
+class BatchFit
+{
+public:
+    // Polylines are handed out in chunks of about this many points.
+    enum { DefaultGrainSize = 4096 };
+
+    explicit BatchFit(int threadCount = 0, int grainSize = DefaultGrainSize)
+        : threadCount(threadCount > 0 ? threadCount : QThread::idealThreadCount())
+        , grainSize(qMax(grainSize, 1)) {
+    }
+
+public:
+    SegmentBatch fit(const QVector<QVector<QPointF> > &polylines, qreal error)
+    {
+        QVector<const QPointF *> starts(polylines.count());
+        QVector<int> offsets(polylines.count() + 1);
+        offsets[0] = 0;
+        for (int i = 0; i < polylines.count(); ++i) {
+            starts[i] = polylines.at(i).constData();
+            offsets[i + 1] = offsets.at(i) + polylines.at(i).count();
+        }
+
+        return fit(starts.constData(), offsets.constData(), polylines.count(), error);
+    }
+
+    SegmentBatch fit(const QVector<QPointF> &points, const QVector<int> &offsets, qreal error)
+    {
+        // Offsets must start at 0, never decrease and stay within points.
+        if (offsets.isEmpty() || offsets.first() != 0 || offsets.last() > points.count())
+            return SegmentBatch();
+        for (int i = 1; i < offsets.count(); ++i) {
+            if (offsets.at(i) < offsets.at(i - 1))
+                return SegmentBatch();
+        }
+
+        int c = offsets.count() - 1;
+        QVector<const QPointF *> starts(c);
+        for (int i = 0; i < c; ++i) {
+            starts[i] = points.constData() + offsets.at(i);
+        }
+
+        return fit(starts.constData(), offsets.constData(), c, error);
+    }
+
+private:
+    SegmentBatch fit(const QPointF *const *starts, const int *offsets, int c, qreal error)
+    {
+        // Polyline i starts at starts[i] and has offsets[i + 1] - offsets[i]
+        // points. Chunks are contiguous runs of polylines and are joined in
+        // order, so the result does not depend on which worker fitted what.
+
+        Chunks chunks;
+        chunks.starts = starts;
+        chunks.offsets = offsets;
+        chunks.error = error;
+        chunks.counts.resize(c + 1);
+        chunks.counts[0] = 0;
+
+        int first = 0;
+        for (int i = 0; i < c; ++i) {
+            if ((offsets[i + 1] - offsets[first] >= grainSize) || (i == c - 1)) {
+                Chunk chunk;
+                chunk.first = first;
+                chunk.last = i;
+                chunks.chunks.append(chunk);
+                first = i + 1;
+            }
+        }
+
+        int workers = qMin(threadCount, chunks.chunks.count());
+        if (workers < 2) {
+            // One chunk for everything, its segments need no join.
+            chunks.chunks.resize(qMin(c, 1));
+            if (c > 0)
+                chunks.chunks.first().last = c - 1;
+            Worker(&chunks).run();
+        } else {
+            QThreadPool pool;
+            pool.setMaxThreadCount(workers);
+
+            QVector<Worker *> running;
+            for (int i = 0; i < workers; ++i) {
+                running.append(new Worker(&chunks));
+                pool.start(running.last());
+            }
+            pool.waitForDone();
+            for (Worker *worker : running)
+                delete worker;
+        }
+
+        // Each worker wrote the segment count of its polylines, the offsets
+        // are their running sum.
+        SegmentBatch batch;
+        batch.offsets = chunks.counts;
+        int *offsetsOut = batch.offsets.data();
+        for (int i = 0; i < c; ++i) {
+            offsetsOut[i + 1] += offsetsOut[i];
+        }
+
+        if (chunks.chunks.count() == 1) {
+            batch.segments = chunks.chunks.first().segments;
+        } else {
+            batch.segments.reserve(offsetsOut[c]);
+            for (const Chunk &chunk : chunks.chunks) {
+                batch.segments += chunk.segments;
+            }
+        }
+
+        return batch;
+    }
+
+private:
+    struct Chunk
+    {
+        int              first;
+        int              last;
+        QVector<Segment> segments;
+    };
+
+    struct Chunks
+    {
+        const QPointF *const *starts;
+        const int            *offsets;
+        qreal                 error;
+
+        QVector<Chunk> chunks;
+        QVector<int>   counts;
+        QAtomicInt     next;
+    };
+
+    class Worker : public QRunnable
+    {
+    public:
+        explicit Worker(Chunks *chunks)
+            : chunks(chunks)
+            , chunk(chunks->chunks.data())
+            , counts(chunks->counts.data()) {
+            setAutoDelete(false);
+        }
+
+    public:
+        void run() Q_DECL_OVERRIDE
+        {
+            // One fitter per worker: its points, parameter buffers and span
+            // stack only grow to the longest polyline and are reused for all
+            // the others.
+
+            for (;;) {
+                int index = chunks->next.fetchAndAddRelaxed(1);
+                if (index >= chunks->chunks.count())
+                    break;
+
+                Chunk &current = chunk[index];
+                current.segments.reserve(segmentEstimate(chunks->offsets[current.last + 1] - chunks->offsets[current.first]) + current.last - current.first + 1);
+                for (int i = current.first; i <= current.last; ++i) {
+                    int count = current.segments.count();
+                    fitter.setPoints(PointSpan(chunks->starts[i], chunks->offsets[i + 1] - chunks->offsets[i]));
+                    fitter.fit(current.segments, chunks->error);
+                    counts[i + 1] = current.segments.count() - count;
+                }
+            }
+        }
+
+    private:
+        Chunks *chunks;
+        Chunk  *chunk;
+        int    *counts;
+        Fitter  fitter;
+    };
+
+private:
+    int threadCount;
+    int grainSize;
+}; // class BatchFit
+
+} // namespace SimplifyQt
+
+#endif // BATCHFIT_H
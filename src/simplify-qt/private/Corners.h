@@ -0,0 +1,96 @@
+#ifndef CORNERS_H
+#define CORNERS_H
+
+#include "../SimplifyQt.h"
+
+#include <QtMath>
+
+#include <cmath>
+
+namespace SimplifyQt {
+
+// Points where the polyline turns by more than angle degrees, found in one
+// pass so that the fit can start with a span per side instead of finding
+// them by failing to fit across.
+//
+// The turn at point i is measured between the chords to the nearest points
+// at least radius before and after it along the line, so that noise within
+// the radius does not count; a run of points that all turn sharply keeps
+// only the sharpest. The indices start with 0 and end with the last point.
+struct Corners
+{
+    template <typename Points>
+    Corners(const Points &points, qreal radius, qreal angle)
+    {
+        int c = points.count();
+        if (c == 0)
+            return;
+
+        indices.append(0);
+        if (c > 2) {
+            find(points, radius, std::cos(qDegreesToRadians(qBound(qreal(0), angle, qreal(180)))));
+        }
+        if (c > 1) {
+            indices.append(c - 1);
+        }
+    }
+
+    // The radius for a fit at tolerance: twice the distance the fitter lets
+    // a point be off its curve. Wider radii found fewer corners and fitted
+    // more segments on every benchmark dataset.
+    static inline qreal radius(qreal tolerance)
+    {
+        return 2 * std::sqrt(qMax(tolerance, qreal(0)));
+    }
+
+    QVector<int> indices;
+
+private:
+    template <typename Points>
+    void find(const Points &points, qreal radius, qreal cosLimit)
+    {
+        // Both neighbours only ever move forward, so the pass is linear in
+        // the number of points.
+
+        const qreal *lengths = points.lengths();
+        const int c = points.count();
+
+        int before = 0;
+        int after = 1;
+        int best = -1;
+        qreal bestCos = cosLimit;
+        for (int i = 1; i < c - 1; ++i) {
+            while ((before + 1 < i) && ((lengths[i] - lengths[before + 1]) >= radius))
+                ++before;
+            after = qMax(after, i + 1);
+            while ((after < c - 1) && ((lengths[after] - lengths[i]) < radius))
+                ++after;
+
+            qreal turnCos = 1;
+            if (((lengths[i] - lengths[before]) >= radius) && ((lengths[after] - lengths[i]) >= radius)) {
+                QPointF in = points.at(i) - points.at(before);
+                QPointF out = points.at(after) - points.at(i);
+                qreal length = std::sqrt(QPointF::dotProduct(in, in) * QPointF::dotProduct(out, out));
+                if (length > 0)
+                    turnCos = QPointF::dotProduct(in, out) / length;
+            }
+
+            if (turnCos < bestCos) {
+                best = i;
+                bestCos = turnCos;
+            } else if ((best >= 0) && (turnCos >= cosLimit)) {
+                // The run of sharp turns ended, its sharpest is the corner.
+                indices.append(best);
+                best = -1;
+                bestCos = cosLimit;
+            }
+        }
+        if (best >= 0) {
+            indices.append(best);
+        }
+    }
+}; // struct Corners
+
+} // namespace SimplifyQt
+
+#endif // CORNERS_H
@@ -0,0 +1,121 @@
+#ifndef CPUFEATURES_H
+#define CPUFEATURES_H
+
+#include <QtGlobal>
+#include <QByteArray>
+
+#if defined(Q_PROCESSOR_X86)
+#  if defined(Q_CC_MSVC)
+#    include <intrin.h>
+#  else
+#    include <cpuid.h>
+#  endif
+#endif
+
+// SSE2 is part of the x86-64 baseline, 32-bit x86 needs it switched on.
+// The kernels work on doubles: with -qreal float only the portable ones
+// are built.
+#if (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) \
+    && !defined(QT_COORD_TYPE)
+#  define SIMPLIFYQT_HAVE_SSE2
+#endif
+
+// AVX2 and AVX-512 kernels are compiled per function (see SIMPLIFYQT_FUNCTION_TARGET)
+// and only called after detectSimdLevel() has confirmed them at runtime.
+#if defined(SIMPLIFYQT_HAVE_SSE2)
+#  if defined(Q_CC_MSVC) && (_MSC_VER >= 1911)
+#    define SIMPLIFYQT_HAVE_AVX2
+#    define SIMPLIFYQT_HAVE_AVX512
+#    define SIMPLIFYQT_FUNCTION_TARGET(x)
+#  elif defined(Q_CC_GNU) || defined(Q_CC_CLANG)
+#    define SIMPLIFYQT_HAVE_AVX2
+#    define SIMPLIFYQT_HAVE_AVX512
+#    define SIMPLIFYQT_FUNCTION_TARGET(x) __attribute__((target(x)))
+#  endif
+#endif
+
+namespace SimplifyQt {
+
+enum SimdLevel
+{
+    SimdNone   = 0, // portable C++
+    SimdSse2   = 1, // SSE2
+    SimdAvx2   = 2, // AVX2 + FMA
+    SimdAvx512 = 3  // AVX-512F
+};
+
+#if defined(Q_PROCESSOR_X86)
+
+static inline void cpuid(quint32 leaf, quint32 subleaf, quint32 regs[4])
+{
+#if defined(Q_CC_MSVC)
+    int info[4];
+    __cpuidex(info, int(leaf), int(subleaf));
+    for (int i = 0; i < 4; ++i)
+        regs[i] = quint32(info[i]);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static inline quint64 xgetbv0()
+{
+#if defined(Q_CC_MSVC)
+    return _xgetbv(0);
+#else
+    quint32 eax, edx;
+    __asm__ __volatile__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+    return (quint64(edx) << 32) | eax;
+#endif
+}
+
+#endif // Q_PROCESSOR_X86
+
+static inline SimdLevel detectSimdLevel()
+{
+    // The CPU has to report the instruction set and the OS has to save the
+    // matching register state (XCR0), otherwise the kernels fault.
+
+    SimdLevel level = SimdNone;
+
+#if defined(Q_PROCESSOR_X86) && defined(SIMPLIFYQT_HAVE_SSE2)
+    quint32 regs[4];
+    cpuid(0, 0, regs);
+    quint32 maxLeaf = regs[0];
+
+    cpuid(1, 0, regs);
+    if (regs[3] & (1u << 26))
+        level = SimdSse2;
+
+#if defined(SIMPLIFYQT_HAVE_AVX2)
+    bool osxsave = regs[2] & (1u << 27);
+    bool avx     = regs[2] & (1u << 28);
+    bool fma     = regs[2] & (1u << 12);
+    if (osxsave && avx && fma && (maxLeaf >= 7)) {
+        quint64 xcr0 = xgetbv0();
+        cpuid(7, 0, regs);
+        if (((xcr0 & 0x06) == 0x06) && (regs[1] & (1u << 5)))
+            level = SimdAvx2;
+#if defined(SIMPLIFYQT_HAVE_AVX512)
+        if ((level == SimdAvx2) && ((xcr0 & 0xe0) == 0xe0) && (regs[1] & (1u << 16)))
+            level = SimdAvx512;
+#endif
+    }
+#endif
+#endif
+
+    // SIMPLIFYQT_SIMD=none|sse2|avx2|avx512 caps the level, e.g. to rule out a kernel in production.
+    const QByteArray cap = qgetenv("SIMPLIFYQT_SIMD").toLower();
+    if (cap == "none")
+        level = SimdNone;
+    else if (cap == "sse2")
+        level = qMin(level, SimdSse2);
+    else if (cap == "avx2")
+        level = qMin(level, SimdAvx2);
+
+    return level;
+}
+
+} // namespace SimplifyQt
+
+#endif // CPUFEATURES_H
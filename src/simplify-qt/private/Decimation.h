@@ -0,0 +1,66 @@
+#ifndef DECIMATION_H
+#define DECIMATION_H
+
+#include "../SimplifyQt.h"
+
+#include <cmath>
+
+namespace SimplifyQt {
+
+// Points left after a radial distance pass, and the tolerance to fit them
+// with so that the dropped ones still end up within the caller's.
+//
+// The fitter accepts a curve when the squared distance of every point is
+// below the tolerance, so a kept point is within sqrt(tolerance) of it. A
+// dropped point is within the radius of the last kept one, hence within
+// sqrt(tolerance') + radius of the curve: the kept points are fitted with
+// sqrt(tolerance') = sqrt(tolerance) - radius.
+struct Decimation
+{
+    Decimation(const PointSpan &points, qreal tolerance, qreal fraction)
+    {
+        fraction = qBound(qreal(0), fraction, qreal(1));
+        qreal distance = std::sqrt(qMax(tolerance, qreal(0)));
+        qreal radius = fraction * distance;
+        this->tolerance = tolerance * (1 - fraction) * (1 - fraction);
+
+        decimate(points, radius);
+    }
+
+    QVector<QPointF> points;
+    qreal            tolerance;
+
+private:
+    void decimate(const PointSpan &span, qreal radius)
+    {
+        // One pass: a point is kept once it is at least radius away from the
+        // last kept one. The first and last points are always kept.
+
+        int c = span.count();
+        if (c == 0)
+            return;
+
+        const qreal r2 = radius * radius;
+        QPointF kept = span.at(0);
+        points.reserve(c);
+        points.append(kept);
+        for (int i = 1; i < c - 1; ++i) {
+            QPointF point = span.at(i);
+            qreal dx = point.x() - kept.x();
+            qreal dy = point.y() - kept.y();
+            if ((dx * dx + dy * dy) >= r2) {
+                points.append(point);
+                kept = point;
+            }
+        }
+
+        // The last point too, unless it repeats the last kept one.
+        if ((c > 1) && (span.at(c - 1) != kept)) {
+            points.append(span.at(c - 1));
+        }
+    }
+}; // struct Decimation
+
+} // namespace SimplifyQt
+
+#endif // DECIMATION_H
@@ -0,0 +1,76 @@
+#ifndef FITSPAN_H
+#define FITSPAN_H
+
+#include <QPointF>
+#include <QVector>
+
+#include "ScratchArena.h"
+
+namespace SimplifyQt {
+
+// A run of points [first, last] still to be fitted, with the tangents the
+// curve has to leave first and enter last with.
+struct FitSpan
+{
+    int     first;
+    int     last;
+    QPointF tan1;
+    QPointF tan2;
+};
+
+} // namespace SimplifyQt
+
+Q_DECLARE_TYPEINFO(SimplifyQt::FitSpan, Q_PRIMITIVE_TYPE);
+
+namespace SimplifyQt {
+
+// How long fitSpan() refines the parameters of a span before it splits it.
+// PathFitter.js gives up after five rounds whether or not they still help;
+// here a round has to take MinFitGain of the error off the one before, and
+// MaxFitRounds only bounds spans that keep creeping down.
+const int MaxFitRounds = 16;
+const qreal MinFitGain = 0.05;
+
+// Splitting at the point of largest error can cut one point off a span at a
+// time, when every curve misses near its end, and fitting then takes time
+// quadratic in the number of points. A balanced split is moved into the
+// middle half of the span, so neither part keeps more than three quarters
+// of it: spans nest at most log4/3(n) deep and each level costs linear time.
+// Spans shorter than MinBalancedSpan edges split where the error is.
+const int MinBalancedSpan = 16;
+
+inline int balancedSplit(int first, int last, int split)
+{
+    if (last - first < MinBalancedSpan)
+        return split;
+
+    const int quarter = (last - first) / 4;
+    return qBound(first + quarter, split, last - quarter);
+}
+
+// What to reserve for the segments of count points. One segment per edge
+// always suffices, but takes 48 bytes a point, a second allocation and copy
+// to squeeze away and, past about 44 million points, more than a QVector
+// can hold; fits of usual input need far fewer, and the vector grows when
+// noisy input needs more.
+inline int segmentEstimate(int count)
+{
+    return qMin(count, count / 8 + 16);
+}
+
+// Working memory of one fitting thread: parameter buffers and the stack of
+// pending spans. Kept apart from the fitter so several threads can fit
+// spans of the same points.
+struct FitScratch
+{
+    explicit FitScratch(int capacity = 0)
+        : arena(capacity) {
+    }
+
+    ScratchArena     arena;
+    QVector<FitSpan> spans;
+};
+
+} // namespace SimplifyQt
+
+#endif // FITSPAN_H
@@ -0,0 +1,123 @@
+#ifndef FITSTATSCOLLECTOR_H
+#define FITSTATSCOLLECTOR_H
+
+#include <QElapsedTimer>
+#include <QVector>
+
+#include "../SimplifyQt.h"
+
+namespace SimplifyQt {
+
+// The Stats of a fit that is not watched. Every hook is empty and clock() is
+// a constant, so a fitter instantiated with it has nothing left of them.
+struct NoFitStats
+{
+    inline qint64 clock() const { return 0; }
+
+    inline void pushed() {}
+    inline void popped() {}
+    inline void split(int index) { Q_UNUSED(index); }
+    inline void line() {}
+    inline void rounds(int count) { Q_UNUSED(count); }
+    inline void earlyBreak() {}
+    inline void foundRoot() {}
+
+    inline void parameterized(qint64 since) { Q_UNUSED(since); }
+    inline void generated(qint64 since) { Q_UNUSED(since); }
+    inline void measured(qint64 since) { Q_UNUSED(since); }
+    inline void reparameterized(qint64 since) { Q_UNUSED(since); }
+};
+
+// The Stats of a fit that fills in a FitStats. Spans carry no depth, so the
+// collector keeps one per pending span, pushed and popped along with the
+// fitter's stack.
+class FitStatsCollector
+{
+public:
+    explicit FitStatsCollector(FitStats &stats)
+        : stats(stats)
+        , depth(0) {
+        timer.start();
+    }
+
+public:
+    inline qint64 clock() const
+    {
+        return timer.nsecsElapsed();
+    }
+
+    // The whole span, at depth 0.
+    inline void pushed()
+    {
+        depths.append(0);
+    }
+
+    inline void popped()
+    {
+        depth = depths.takeLast();
+        stats.maxDepth = qMax(stats.maxDepth, depth);
+        ++stats.spans;
+    }
+
+    // The popped span was split at index, both halves are pending.
+    inline void split(int index)
+    {
+        depths.append(depth + 1);
+        depths.append(depth + 1);
+        stats.splits.append(index);
+    }
+
+    inline void line()
+    {
+        ++stats.lineSpans;
+    }
+
+    inline void rounds(int count)
+    {
+        if (stats.iterationHistogram.count() < count)
+            stats.iterationHistogram.resize(count);
+        ++stats.iterationHistogram[count - 1];
+        stats.iterations += count;
+    }
+
+    inline void earlyBreak()
+    {
+        ++stats.earlyBreaks;
+    }
+
+    inline void foundRoot()
+    {
+        ++stats.findRootCalls;
+    }
+
+    inline void parameterized(qint64 since)
+    {
+        stats.parameterizeTime += clock() - since;
+    }
+
+    inline void generated(qint64 since)
+    {
+        stats.generateBezierTime += clock() - since;
+    }
+
+    inline void measured(qint64 since)
+    {
+        stats.findMaxErrorTime += clock() - since;
+    }
+
+    inline void reparameterized(qint64 since)
+    {
+        stats.reparameterizeTime += clock() - since;
+        ++stats.reparameterizeCalls;
+    }
+
+private:
+    FitStats     &stats;
+    QElapsedTimer timer;
+    QVector<int>  depths;
+    int           depth;
+}; // class FitStatsCollector
+
+} // namespace SimplifyQt
+
+#endif // FITSTATSCOLLECTOR_H
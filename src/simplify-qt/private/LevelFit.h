@@ -0,0 +1,170 @@
+#ifndef LEVELFIT_H
+#define LEVELFIT_H
+
+#include "../SimplifyQt.h"
+
+#include <QtAlgorithms>
+
+#include "FitSpan.h"
+
+namespace SimplifyQt {
+
+// Fits the points of one fitter at several tolerances in a single walk.
+//
+// On a given span the iterations of Fitter::fitSpan() - the curves, their
+// errors and the refined parameters - do not depend on the tolerance, only
+// the decision to accept, keep going or split does. So each span is
+// iterated once for every tolerance that reaches it: coarse tolerances
+// accept early and drop out, finer ones that split at the same point go on
+// together. Every tolerance gets exactly the segments of Fitter::fit().
+template <typename Fitter, typename Real = qreal>
+class LevelFit
+{
+public:
+    // Tolerances are taken in groups of this many, one bit each.
+    enum { MaxLevels = 64 };
+
+    explicit LevelFit(const Fitter &fitter)
+        : fitter(fitter)
+        , scratch(fitter.path().count()) {
+    }
+
+public:
+    QVector<QVector<Segment> > fit(const QVector<qreal> &errors)
+    {
+        QVector<QVector<Segment> > levels(errors.count());
+        for (int first = 0; first < errors.count(); first += MaxLevels) {
+            int count = qMin(int(MaxLevels), errors.count() - first);
+            fit(errors.constData() + first, levels.data() + first, count);
+        }
+
+        return levels;
+    }
+
+private:
+    struct LevelSpan
+    {
+        FitSpan span;
+        quint64 levels;
+    };
+
+    void fit(const qreal *errors, QVector<Segment> *levels, int count)
+    {
+        const int c = fitter.path().count();
+        for (int l = 0; l < count; ++l) {
+            levels[l].reserve(segmentEstimate(c));
+            if (c > 0)
+                fitter.addFirst(levels[l], fitter.path().first());
+        }
+        if (c < 2)
+            return;
+
+        const quint64 all = (count == MaxLevels) ? ~quint64(0) : ((quint64(1) << count) - 1);
+        FitSpan root = { 0, c - 1, fitter.path().at(1) - fitter.path().at(0), fitter.path().at(c - 2) - fitter.path().at(c - 1) };
+
+        stack.clear();
+        stack.append(LevelSpan { root, all });
+        while (!stack.isEmpty()) {
+            LevelSpan next = stack.last();
+            stack.removeLast();
+            fitSpan(errors, levels, next);
+        }
+    }
+
+    void fitSpan(const qreal *errors, QVector<Segment> *levels, const LevelSpan &next)
+    {
+        // Fitter::fitSpan() for every level in next.levels at once.
+
+        const int first = next.span.first;
+        const int last = next.span.last;
+        const QPointF &tan1 = next.span.tan1;
+        const QPointF &tan2 = next.span.tan2;
+
+        if ((last - first) == 1) {
+            const QPointF pt1 = fitter.path().at(first);
+            const QPointF pt2 = fitter.path().at(last);
+            qreal dist = Fitter::getDistance(pt1, pt2) / 3;
+            QPointF curve1 = pt1 + Fitter::normalize(tan1, dist);
+            QPointF curve2 = pt2 + Fitter::normalize(tan2, dist);
+            for (quint64 m = next.levels; m; m &= m - 1) {
+                fitter.addCurve(levels[lowestBit(m)], pt1, curve1, curve2, pt2);
+            }
+            return;
+        }
+
+        ScratchArena::Scope scope(scratch.arena);
+        Real *uPrime = scratch.arena.allocate<Real>(last - first + 1);
+        fitter.chordLengthParameterize(first, last, uPrime);
+
+        qreal maxErrors[MaxLevels];
+        int splits[MaxLevels];
+        for (quint64 m = next.levels; m; m &= m - 1) {
+            int l = lowestBit(m);
+            maxErrors[l] = qMax(errors[l], errors[l] * errors[l]);
+        }
+
+        quint64 active = next.levels;
+        quint64 split = 0;
+        bool parametersInOrder = true;
+        for (int i = 0; (i < MaxFitRounds) && active; ++i) {
+            QPointF curve[4];
+            fitter.generateBezier(first, last, uPrime, tan1, tan2, curve);
+            QPair<qreal, int> max = fitter.findMaxError(first, last, curve, uPrime);
+
+            quint64 running = active;
+            for (quint64 m = running; m; m &= m - 1) {
+                int l = lowestBit(m);
+                quint64 bit = quint64(1) << l;
+                if ((max.first < errors[l]) && parametersInOrder) {
+                    fitter.addCurve(levels[l], curve[0], curve[1], curve[2], curve[3]);
+                    active &= ~bit;
+                    continue;
+                }
+                splits[l] = max.second;
+                if (max.first >= maxErrors[l]) {
+                    active &= ~bit;
+                    split |= bit;
+                    continue;
+                }
+                maxErrors[l] = max.first * (1 - MinFitGain);
+            }
+
+            if (active) {
+                parametersInOrder = fitter.reparameterize(first, last, uPrime, curve);
+            }
+        }
+        split |= active;
+
+        // Levels that split at the same point share the halves. Right halves
+        // go on the stack first so that every level sees its spans in the
+        // order of Fitter::fitCubic().
+        while (split) {
+            int at = splits[lowestBit(split)];
+            quint64 same = 0;
+            for (quint64 m = split; m; m &= m - 1) {
+                int l = lowestBit(m);
+                if (splits[l] == at)
+                    same |= quint64(1) << l;
+            }
+            split &= ~same;
+
+            QPointF tanCenter = fitter.path().at(at - 1) - fitter.path().at(at + 1);
+            stack.append(LevelSpan { { at, last, tanCenter * -1, tan2 }, same });
+            stack.append(LevelSpan { { first, at, tan1, tanCenter }, same });
+        }
+    }
+
+    static inline int lowestBit(quint64 mask)
+    {
+        return qCountTrailingZeroBits(mask);
+    }
+
+private:
+    const Fitter      &fitter;
+    FitScratch         scratch;
+    QVector<LevelSpan> stack;
+}; // class LevelFit
+
+} // namespace SimplifyQt
+
+#endif // LEVELFIT_H
@@ -0,0 +1,259 @@
+#ifndef PARALLELFIT_H
+#define PARALLELFIT_H
+
+#include "../SimplifyQt.h"
+
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+#include "FitSpan.h"
+#include "PathPoints.h"
+
+namespace SimplifyQt {
+
+template <typename Fitter>
+class ParallelFit
+{
+public:
+    // Right halves shorter than this stay with the task that split them.
+    enum { DefaultGrainSize = 2048 };
+
+    explicit ParallelFit(Fitter &fitter, int threadCount = 0, int grainSize = DefaultGrainSize)
+        : fitter(fitter)
+        , threadCount(threadCount > 0 ? threadCount : QThread::idealThreadCount())
+        , grainSize(qMax(grainSize, 2)) {
+    }
+
+public:
+    QVector<Segment> fit(qreal error)
+    {
+        const PathPoints &points = fitter.path();
+        int c = points.count();
+        if ((threadCount < 2) || (c < 2 * grainSize)) {
+            return fitter.fit(error);
+        }
+
+        // Every span fits the same way whichever thread takes it, and the
+        // task outputs are joined in span order, so the result is bit-for-bit
+        // the one of Fitter::fit().
+
+        QThreadPool pool;
+        pool.setMaxThreadCount(threadCount);
+
+        FitSpan span = { 0, c - 1, points.at(1) - points.at(0), points.at(c - 2) - points.at(c - 1) };
+        Task root(this, &pool, error, span);
+        pool.start(&root);
+        pool.waitForDone();
+
+        QVector<Segment> segments;
+        segments.reserve(segmentEstimate(c));
+        segments.append(Segment(points.first()));
+        join(segments, &root);
+
+        return segments;
+    }
+
+    // Fits the spans between consecutive corners, indices that start with 0
+    // and end with the last point, each with the tangents of its own ends.
+    // Consecutive spans are grouped into tasks of at least grainSize points;
+    // a span larger than that still splits across threads like in fit().
+    // The result does not depend on the number of threads.
+    QVector<Segment> fit(qreal error, const QVector<int> &corners)
+    {
+        const PathPoints &points = fitter.path();
+        int c = points.count();
+        if (c < 2) {
+            return fitter.fit(error);
+        }
+
+        QVector<Segment> segments;
+        segments.reserve(segmentEstimate(c));
+        segments.append(Segment(points.first()));
+
+        if ((threadCount < 2) || (c < 2 * grainSize)) {
+            FitScratch scratch(c);
+            for (int k = 1; k < corners.count(); ++k) {
+                fitter.fitCubic(scratch, segments, error, cornerSpan(corners.at(k - 1), corners.at(k)));
+            }
+            return segments;
+        }
+
+        QThreadPool pool;
+        pool.setMaxThreadCount(threadCount);
+
+        QVector<Task *> tasks;
+        QVector<FitSpan> spans;
+        for (int k = 1; k < corners.count(); ++k) {
+            spans.append(cornerSpan(corners.at(k - 1), corners.at(k)));
+            if (((spans.last().last - spans.first().first + 1) >= grainSize) || (k == corners.count() - 1)) {
+                FitSpan span = { spans.first().first, spans.last().last, spans.first().tan1, spans.last().tan2 };
+                Task *task = new Task(this, &pool, error, span);
+                task->seeds = spans;
+                tasks.append(task);
+                spans.clear();
+            }
+        }
+        for (Task *task : tasks) {
+            pool.start(task);
+        }
+        pool.waitForDone();
+
+        for (Task *task : tasks) {
+            join(segments, task);
+            delete task;
+        }
+
+        return segments;
+    }
+
+private:
+    FitSpan cornerSpan(int first, int last) const
+    {
+        const PathPoints &points = fitter.path();
+        FitSpan span = { first, last, points.at(first + 1) - points.at(first), points.at(last - 1) - points.at(last) };
+        return span;
+    }
+
+    class Task : public QRunnable
+    {
+    public:
+        Task(ParallelFit *owner, QThreadPool *pool, qreal error, const FitSpan &span)
+            : owner(owner)
+            , pool(pool)
+            , error(error)
+            , span(span) {
+            setAutoDelete(false);
+        }
+
+        ~Task()
+        {
+            for (const Join &join : joins)
+                delete join.task;
+        }
+
+    public:
+        void run() Q_DECL_OVERRIDE
+        {
+            // Fitter::fitCubic() with one change: a right half of at least
+            // grainSize points becomes a task of its own, and a marker keeps
+            // its place on the stack. When the marker comes up, the segment
+            // at the end of that half is stood in for until the join.
+
+            const Fitter &fitter = owner->fitter;
+            const PathPoints &points = fitter.path();
+            FitScratch scratch(span.last - span.first + 1);
+
+            segments.append(Segment(points.at(span.first)));
+
+            QVector<Pending> stack;
+            if (seeds.isEmpty()) {
+                stack.append(Pending { span, nullptr });
+            }
+            for (int k = seeds.count() - 1; k >= 0; --k) {
+                stack.append(Pending { seeds.at(k), nullptr });
+            }
+            while (!stack.isEmpty()) {
+                Pending next = stack.last();
+                stack.removeLast();
+
+                if (next.task) {
+                    joins.append(Join { segments.count(), next.task });
+                    segments.append(Segment(points.at(next.task->span.last)));
+                    continue;
+                }
+
+                FitSpan left;
+                FitSpan right;
+                if (fitter.fitSpan(scratch, segments, error, next.span, &left, &right)) {
+                    continue;
+                }
+
+                if ((right.last - right.first + 1) >= owner->grainSize) {
+                    Task *task = new Task(owner, pool, error, right);
+                    stack.append(Pending { FitSpan(), task });
+                    pool->start(task);
+                } else {
+                    stack.append(Pending { right, nullptr });
+                }
+                stack.append(Pending { left, nullptr });
+            }
+        }
+
+    public:
+        struct Pending
+        {
+            FitSpan span;
+            Task   *task;
+        };
+
+        struct Join
+        {
+            int   index;
+            Task *task;
+        };
+
+        ParallelFit *owner;
+        QThreadPool *pool;
+        qreal        error;
+        FitSpan      span;
+
+        // Spans fitted one after the other instead of span, which then
+        // only covers them.
+        QVector<FitSpan> seeds;
+
+        QVector<Segment> segments;
+        QVector<Join>    joins;
+    };
+
+    static void join(QVector<Segment> &segments, const Task *root)
+    {
+        // Depth-first walk over the task tree without recursion. Each task
+        // output starts with the segment at its first point, which only
+        // contributes the handle its first curve set; a stand-in for a
+        // child only contributes the handle of the curve after the child.
+
+        struct Frame
+        {
+            const Task *task;
+            int         join;
+            int         index;
+        };
+
+        QVector<Frame> frames;
+        segments.last().setControl2(root->segments.first().control2());
+        frames.append(Frame { root, 0, 1 });
+        while (!frames.isEmpty()) {
+            Frame &frame = frames.last();
+            const Task *task = frame.task;
+
+            int end = (frame.join < task->joins.count()) ? task->joins.at(frame.join).index : task->segments.count();
+            for (; frame.index < end; ++frame.index) {
+                segments.append(task->segments.at(frame.index));
+            }
+
+            if (frame.join < task->joins.count()) {
+                const Task *child = task->joins.at(frame.join).task;
+                ++frame.join;
+                segments.last().setControl2(child->segments.first().control2());
+                frames.append(Frame { child, 0, 1 });
+            } else {
+                frames.removeLast();
+                if (!frames.isEmpty()) {
+                    Frame &parent = frames.last();
+                    segments.last().setControl2(parent.task->segments.at(parent.index).control2());
+                    ++parent.index;
+                }
+            }
+        }
+    }
+
+private:
+    Fitter &fitter;
+    int     threadCount;
+    int     grainSize;
+}; // class ParallelFit
+
+} // namespace SimplifyQt
+
+#endif // PARALLELFIT_H
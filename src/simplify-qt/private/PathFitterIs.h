@@ -3,27 +3,93 @@
 
 #include "../SimplifyQt.h"
 
-#include <xmmintrin.h>
-#include <emmintrin.h>
+#include "PathKernels.h"
+#include "FitSpan.h"
+#include "FitStatsCollector.h"
+#include "PathPoints.h"
+#include "PowerBasis.h"
+
+#include <cmath>
 
 namespace SimplifyQt {
 
-class PathFitterIs
+// The fitter on points of type Real: PathFitterIs on qreal, PathFitterIsF on
+// float. Curves and tangents are qreal either way, only the per-point arrays
+// and the kernels that run over them change width.
+template <typename Real>
+class BasicPathFitterIs
 {
 public:
-    explicit PathFitterIs(const QVector<QPointF> &points)
-        : points(points) {
-        if (!points.isEmpty()) {
-            QPointF last = points.first();
-            for (const QPointF &point : points) {
-                distances.append(getDistance(last, point));
-                last = point;
-            }
-        }
+    typedef typename PathTraits<Real>::Kernels Kernels;
+
+    explicit BasicPathFitterIs(const PointSpan &points, const Kernels &kernels = PathTraits<Real>::best())
+        : kernels(kernels)
+        , points(points, kernels)
+        , scratch(points.count())
+        , balanced(false) {
+    }
+
+    // A fitter without points, for setPoints() to fill: its buffers are
+    // reused from one polyline to the next.
+    explicit BasicPathFitterIs(const Kernels &kernels = PathTraits<Real>::best())
+        : kernels(kernels)
+        , balanced(false) {
+    }
+
+public:
+    void setPoints(const PointSpan &points)
+    {
+        this->points.assign(points, kernels);
+    }
+
+    // Grows the buffers for polylines of up to count points, so that
+    // setPoints() and fit() on them need no more memory.
+    void reserve(int count)
+    {
+        points.reserve(count);
+        scratch.arena.reserve(count);
+        scratch.spans.reserve(count);
+    }
+
+    // Whether splits are kept to the middle half of a span, see
+    // balancedSplit(). Off by default, where spans split at the point of
+    // largest error and adversarial input takes quadratic time; on, no
+    // input takes more than O(n log n), but the curves come out slightly
+    // different.
+    void setBalanced(bool balanced)
+    {
+        this->balanced = balanced;
+    }
+
+    bool isBalanced() const
+    {
+        return balanced;
     }
 
 public:
     QVector<Segment> fit(qreal error)
+    {
+        QVector<Segment> segments;
+
+        segments.reserve(segmentEstimate(points.count()));
+        fit(segments, error);
+
+        return segments;
+    }
+
+    // Appends the segments of the points to segments, a QVector<Segment> or
+    // a CurveSink.
+    template <typename Output>
+    void fit(Output &segments, qreal error)
+    {
+        NoFitStats stats;
+        fit(segments, error, stats);
+    }
+
+    // The same, telling stats - NoFitStats or FitStatsCollector - what the
+    // fit does on the way.
+    template <typename Output, typename Stats>
+    void fit(Output &segments, qreal error, Stats &stats)
     {
         /* JavaScript
         if (length > 0) {
@@ -42,25 +108,74 @@ public:
         return segments;
          */
 
-        QVector<Segment> segments;
-
         int c = points.count();
         if (c > 0) {
-            segments.append(Segment(points.first()));
+            addFirst(segments, points.first());
             if (c > 1) {
-                fitCubic(segments, error, 0, c - 1,
-                         points[1] - points[0], points[c - 2] - points[c - 1]);
+                FitSpan span = { 0, c - 1, points.at(1) - points.at(0), points.at(c - 2) - points.at(c - 1) };
+                fitCubic(scratch, segments, error, span, stats);
             }
         }
-
-        return segments;
     }
 
 public:
-    void fitCubic(QVector<Segment> &segments, qreal error, int first, int last, const QPointF &tan1, const QPointF &tan2) const
+    template <typename Output>
+    void fitCubic(Output &segments, qreal error, int first, int last, const QPointF &tan1, const QPointF &tan2) const
+    {
+        FitSpan span = { first, last, tan1, tan2 };
+        fitCubic(scratch, segments, error, span);
+    }
+
+    template <typename Output>
+    void fitCubic(FitScratch &scratch, Output &segments, qreal error, FitSpan span) const
+    {
+        NoFitStats stats;
+        fitCubic(scratch, segments, error, span, stats);
+    }
+
+    template <typename Output, typename Stats>
+    void fitCubic(FitScratch &scratch, Output &segments, qreal error, FitSpan span, Stats &stats) const
+    {
+        // The recursion of PathFitter.js on an explicit stack: the right half
+        // waits while the left one is fitted, so curves come out in the same
+        // order. Pending spans never overlap, so the stack is bounded by the
+        // number of edges and lives on the heap, not on the thread's stack.
+
+        QVector<FitSpan> &spans = scratch.spans;
+        spans.append(span);
+        stats.pushed();
+        while (!spans.isEmpty()) {
+            span = spans.last();
+            spans.removeLast();
+            stats.popped();
+
+            FitSpan left;
+            FitSpan right;
+            if (!fitSpan(scratch, segments, error, span, &left, &right, stats)) {
+                spans.append(right);
+                spans.append(left);
+                stats.split(left.last);
+            }
+        }
+    }
+
+    template <typename Output>
+    bool fitSpan(FitScratch &scratch, Output &segments, qreal error, const FitSpan &span, FitSpan *left, FitSpan *right) const
+    {
+        NoFitStats stats;
+        return fitSpan(scratch, segments, error, span, left, right, stats);
+    }
+
+    template <typename Output, typename Stats>
+    bool fitSpan(FitScratch &scratch, Output &segments, qreal error, const FitSpan &span, FitSpan *left, FitSpan *right, Stats &stats) const
     {
         // src/path/PathFitter.js
 
+        const int first = span.first;
+        const int last = span.last;
+        const QPointF &tan1 = span.tan1;
+        const QPointF &tan2 = span.tan2;
+
         /* JavaScript
         var points = this.points;
         if (last - first === 1) {
@@ -74,15 +189,16 @@ public:
         */
 
         if ((last - first) == 1) {
-            const QPointF &pt1 = points[first];
-            const QPointF &pt2 = points[last];
+            const QPointF pt1 = points.at(first);
+            const QPointF pt2 = points.at(last);
             qreal dist = getDistance(pt1, pt2) / 3;
             addCurve(segments,
                      pt1,
                      pt1 + normalize(tan1, dist),
                      pt2 + normalize(tan2, dist),
                      pt2);
-            return;
+            stats.line();
+            return true;
         }
 
         /* JavaScript
@@ -108,31 +224,51 @@ public:
         this.fitCubic(segments, error, split, last, tanCenter.negate(), tan2);
         */
 
-        QVector<qreal> uPrime = chordLengthParameterize(first, last);
+        ScratchArena::Scope scope(scratch.arena);
+        Real *uPrime = scratch.arena.allocate<Real>(last - first + 1);
+        qint64 since = stats.clock();
+        chordLengthParameterize(first, last, uPrime);
+        stats.parameterized(since);
+
         qreal maxError = qMax(error, error * error);
         int split = 0;
         bool parametersInOrder = true;
-        for (int i = 0; i <= 4; ++i) {
+        int rounds = 0;
+        for (int i = 0; i < MaxFitRounds; ++i) {
             QPointF curve[4];
+            ++rounds;
+            since = stats.clock();
             generateBezier(first, last, uPrime, tan1, tan2, curve);
+            stats.generated(since);
+            since = stats.clock();
             QPair<qreal, int> max = findMaxError(first, last, curve, uPrime);
+            stats.measured(since);
             if ((max.first < error) && parametersInOrder) {
                 addCurve(segments, curve[0], curve[1], curve[2], curve[3]);
-                return;
+                stats.rounds(rounds);
+                return true;
             }
             split = max.second;
-            if (max.first >= maxError)
+            if (max.first >= maxError) {
+                stats.earlyBreak();
                 break;
-            parametersInOrder = reparameterize(first, last, uPrime, curve);
-            maxError = max.first;
+            }
+            since = stats.clock();
+            parametersInOrder = reparameterize(first, last, uPrime, curve, stats);
+            stats.reparameterized(since);
+            maxError = max.first * (1 - MinFitGain);
         }
-        QPointF tanCenter = points[split - 1] - points[split + 1];
-
-        fitCubic(segments, error, first, split, tan1, tanCenter);
-        fitCubic(segments, error, split, last, tanCenter * -1, tan2);
+        stats.rounds(rounds);
+        if (balanced)
+            split = balancedSplit(first, last, split);
+        QPointF tanCenter = points.at(split - 1) - points.at(split + 1);
+
+        *left = { first, split, tan1, tanCenter };
+        *right = { split, last, tanCenter * -1, tan2 };
+        return false;
     }
 
-    void generateBezier(int first, int last, const QVector<qreal> &uPrime, const QPointF &tan1, const QPointF &tan2, QPointF *curves) const
+    void generateBezier(int first, int last, const Real *uPrime, const QPointF &tan1, const QPointF &tan2, QPointF *curves) const
     {
         // src/path/PathFitter.js
 
@@ -169,8 +305,10 @@ public:
 
         // https://developer.mozilla.org/zh-CN/docs/Web/JavaScript/Reference/Global_Objects/Number/EPSILON
         qreal epsilon = std::pow(2, -52);
-        const QPointF &pt1 = points[first];
-        const QPointF &pt2 = points[last];
+        const QPointF pt1 = points.at(first);
+        const QPointF pt2 = points.at(last);
+        const Real *x = points.x() + first;
+        const Real *y = points.y() + first;
         qreal C[2][2] = {{0, 0}, {0, 0}};
         qreal X[2] = {0, 0};
 
@@ -184,7 +322,7 @@ public:
             qreal b3 = u * u * u;
             QPointF a1 = normalize(tan1, b1);
             QPointF a2 = normalize(tan2, b2);
-            QPointF tmp = points[first + i]
+            QPointF tmp = QPointF(x[i], y[i])
                     - pt1 * (b0 + b1)
                     - pt2 * (b2 + b3);
             C[0][0] += dot(a1, a1);
@@ -296,10 +434,41 @@ public:
 
         Segment &segment = segments.last();
         segment.setControl2(curve1 - curve0);
-        segments << Segment(curve3, curve2 - curve3);
+        segments << Segment(global(curve3), curve2 - curve3);
+    }
+
+    void addCurve(CurveSink &sink, const QPointF &curve0, const QPointF &curve1, const QPointF &curve2, const QPointF &curve3) const
+    {
+        // The sink takes absolute control points, the start is the end of
+        // the previous curve.
+        Q_UNUSED(curve0);
+        sink.cubicTo(global(curve1), global(curve2), global(curve3));
+    }
+
+    inline void addFirst(QVector<Segment> &segments, const QPointF &point) const
+    {
+        segments.append(Segment(global(point)));
+    }
+
+    inline void addFirst(CurveSink &sink, const QPointF &point) const
+    {
+        sink.moveTo(global(point));
     }
 
-    bool reparameterize(int first, int last, const QVector<qreal> &u, const QPointF *curves) const
+    // A point in the fitter's coordinates moved back to the caller's.
+    inline QPointF global(const QPointF &point) const
+    {
+        return PathTraits<Real>::Recenter ? (point + points.origin()) : point;
+    }
+
+    bool reparameterize(int first, int last, Real *u, const QPointF *curves) const
+    {
+        NoFitStats stats;
+        return reparameterize(first, last, u, curves, stats);
+    }
+
+    template <typename Stats>
+    bool reparameterize(int first, int last, Real *u, const QPointF *curves, Stats &stats) const
     {
         // src/path/PathFitter.js
 
@@ -314,17 +483,24 @@ public:
         return true;
         */
 
-        QVector<qreal> u2 = u;
-        for (int i = first; i <= last; ++i) {
-            u2[i - first] = findRoot(curves, points[i], u2[i - first]);
-        }
-        for (int i = 1, l = u2.count(); i < l; ++i) {
-            if (u2[i] <= u2[i - 1]) {
-                return false;
+        // Every parameter is refined in place, the order is checked on the
+        // way instead of in a second pass. The curve and its derivatives are
+        // converted to power basis once for all of them.
+        const Real *x = points.x() + first;
+        const Real *y = points.y() + first;
+        const PowerBasis<3> curve = powerBasis<3>(curves);
+        const PowerBasis<2> curve1 = derivative(curve);
+        const PowerBasis<1> curve2 = derivative(curve1);
+        bool parametersInOrder = true;
+        for (int i = 0, l = last - first + 1; i < l; ++i) {
+            u[i] = findRoot(curve, curve1, curve2, QPointF(x[i], y[i]), u[i]);
+            stats.foundRoot();
+            if ((i > 0) && (u[i] <= u[i - 1])) {
+                parametersInOrder = false;
             }
         }
 
-        return true;
+        return parametersInOrder;
     }
 
     qreal findRoot(const QPointF *curves, const QPointF &point, qreal u) const
@@ -348,25 +524,26 @@ public:
         return Numerical.isMachineZero(df) ? u : u - diff.dot(pt1) / df;
         */
 
-        QPointF curve1[3];
-        curve1[0] = curve1[1] - curve1[0] * 3;
-        curve1[1] = curve1[2] - curve1[1] * 3;
-        curve1[2] = curve1[3] - curve1[2] * 3;
-
-        QPointF curve2[2];
-        curve2[0] = curve1[1] - curve1[0] * 2;
-        curve2[1] = curve1[2] - curve1[1] * 2;
+        const PowerBasis<3> curve = powerBasis<3>(curves);
+        const PowerBasis<2> curve1 = derivative(curve);
+        return findRoot(curve, curve1, derivative(curve1), point, u);
+    }
 
-        QPointF pt0 = evaluate3(curves, u);
-        QPointF pt1 = evaluate2(curve1, u);
-        QPointF pt2 = evaluate1(curve2, u);
+    // findRoot() on the curve and its derivatives in power basis, with the
+    // derivatives taken from the polynomial rather than from differences of
+    // the control points; the same curves either way.
+    static inline qreal findRoot(const PowerBasis<3> &curve, const PowerBasis<2> &curve1, const PowerBasis<1> &curve2, const QPointF &point, qreal u)
+    {
+        QPointF pt0 = evaluate(curve, u);
+        QPointF pt1 = evaluate(curve1, u);
+        QPointF pt2 = evaluate(curve2, u);
 
         QPointF diff = pt0 - point;
         qreal df = dot(pt1, pt1) + dot(diff, pt2);
         return qFuzzyIsNull(df) ? u : (u - dot(diff, pt1) / df);
     }
 
-    QPair<qreal, int> findMaxError(int first, int last, const QPointF *curves, const QVector<qreal> &u) const
+    QPair<qreal, int> findMaxError(int first, int last, const QPointF *curves, const Real *u) const
     {
         // src/path/PathFitter.js
 
@@ -388,22 +565,17 @@ public:
         };
         */
 
-        int index = std::floor((last - first + 1) / 2.0);
-        qreal maxDist = 0.0;
-        for (int i = first + 1; i < last; ++i) {
-            QPointF P = evaluate3(curves, u[i - first]);
-            QPointF v = P - points[i];
-            qreal dist = v.x() * v.x() + v.y() * v.y();
-            if (dist >= maxDist) {
-                maxDist = dist;
-                index = i;
-            }
+        QPair<qreal, int> max = kernels.findMaxError(points.x() + first, points.y() + first, u, last - first + 1, curves);
+        if (max.second < 0) {
+            max.second = std::floor((last - first + 1) / 2.0);
+        } else {
+            max.second += first;
         }
 
-        return QPair<qreal, int>(maxDist, index);
+        return max;
     }
 
-    QVector<qreal> chordLengthParameterize(int first, int last) const
+    void chordLengthParameterize(int first, int last, Real *u) const
     {
         // src/path/PathFitter.js
 
@@ -419,96 +591,14 @@ public:
         return u;
         */
 
-        QVector<qreal> u{0};
-        for (int i = first + 1; i <= last; ++i) {
-            u << u[i - first - 1] + distances[i];
-        }
-        for (int i = 1, m = last - first; i <= m; ++i) {
-            u[i] = u[i] / u[m];
-        }
-
-        return u;
-    }
-
-    static inline QPointF evaluate1(const QPointF *curves, qreal t)
-    {
-        // src/path/PathFitter.js
-
-        /* JavaScript
-        var tmp = curve.slice();
-        for (var i = 1; i <= degree; i++) {
-            for (var j = 0; j <= degree - i; j++) {
-                tmp[j] = tmp[j].multiply(1 - t).add(tmp[j + 1].multiply(t));
-            }
-        }
-        return tmp[0];
-        */
-
-        return curves[0] * (1 - t) + curves[1] * t;
+        // The constructor already summed the chord lengths, a span only
+        // rebases and normalizes them.
+        kernels.chordLengthParameterize(points.lengths() + first, last - first + 1, u);
     }
 
-    static inline QPointF evaluate2(const QPointF *curves, qreal t)
+    inline const BasicPathPoints<Real> &path() const
     {
-        // src/path/PathFitter.js
-
-        /* JavaScript
-        var tmp = curve.slice();
-        for (var i = 1; i <= degree; i++) {
-            for (var j = 0; j <= degree - i; j++) {
-                tmp[j] = tmp[j].multiply(1 - t).add(tmp[j + 1].multiply(t));
-            }
-        }
-        return tmp[0];
-        */
-
-        __m128d temp[3] {
-            { curves[0].x(), curves[0].y() },
-            { curves[1].x(), curves[1].y() },
-            { curves[2].x(), curves[2].y() }
-        };
-
-        __m128d q1 { 1 - t, 1 - t };
-        __m128d q2 { t    , t     };
-
-        temp[0] = _mm_add_pd(_mm_mul_pd(temp[0], q1), _mm_mul_pd(temp[1], q2));
-        temp[1] = _mm_add_pd(_mm_mul_pd(temp[1], q1), _mm_mul_pd(temp[2], q2));
-        temp[0] = _mm_add_pd(_mm_mul_pd(temp[0], q1), _mm_mul_pd(temp[1], q2));
-
-        return QPointF(temp[0].m128d_f64[0], temp[0].m128d_f64[1]);
-    }
-
-    static inline QPointF evaluate3(const QPointF *curves, qreal t)
-    {
-        // src/path/PathFitter.js
-
-        /* JavaScript
-        var tmp = curve.slice();
-        for (var i = 1; i <= degree; i++) {
-            for (var j = 0; j <= degree - i; j++) {
-                tmp[j] = tmp[j].multiply(1 - t).add(tmp[j + 1].multiply(t));
-            }
-        }
-        return tmp[0];
-        */
-
-        __m128d temp[4] {
-            { curves[0].x(), curves[0].y() },
-            { curves[1].x(), curves[1].y() },
-            { curves[2].x(), curves[2].y() },
-            { curves[3].x(), curves[3].y() }
-        };
-
-        __m128d q1 { 1 - t, 1 - t };
-        __m128d q2 { t    , t     };
-
-        temp[0] = _mm_add_pd(_mm_mul_pd(temp[0], q1), _mm_mul_pd(temp[1], q2));
-        temp[1] = _mm_add_pd(_mm_mul_pd(temp[1], q1), _mm_mul_pd(temp[2], q2));
-        temp[2] = _mm_add_pd(_mm_mul_pd(temp[2], q1), _mm_mul_pd(temp[3], q2));
-        temp[0] = _mm_add_pd(_mm_mul_pd(temp[0], q1), _mm_mul_pd(temp[1], q2));
-        temp[1] = _mm_add_pd(_mm_mul_pd(temp[1], q1), _mm_mul_pd(temp[2], q2));
-        temp[0] = _mm_add_pd(_mm_mul_pd(temp[0], q1), _mm_mul_pd(temp[1], q2));
-
-        return QPointF(temp[0].m128d_f64[0], temp[0].m128d_f64[1]);
+        return points;
     }
 
     static inline qreal dot(const QPointF &o, const QPointF &point)
@@ -573,9 +663,20 @@ public:
     }
 
 private:
-    QVector<QPointF> points;
-    QVector<qreal>   distances;
-}; // class PathFitterIs
+    const Kernels &kernels;
+
+private:
+    BasicPathPoints<Real> points;
+
+private:
+    mutable FitScratch scratch;
+    bool               balanced;
+}; // class BasicPathFitterIs
+
+typedef BasicPathFitterIs<qreal> PathFitterIs;
+#if !defined(QT_COORD_TYPE)
+typedef BasicPathFitterIs<float> PathFitterIsF;
+#endif
 
 } // namespace SimplifyQt
 
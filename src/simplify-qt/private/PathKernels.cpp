@@ -0,0 +1,549 @@
+// GCC fuses a separate multiply and add into an FMA whenever the target has
+// one, clang within an expression, which would make the kernels round
+// differently from the scalar code. FMA is only used where a kernel asks
+// for it explicitly. simplify-qt.pri passes -ffp-contract=off as well, for
+// the fitters compiled into the other files; the pragmas keep this file
+// exact when it is built without it.
+#if defined(__clang__)
+#  pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#  pragma GCC optimize ("fp-contract=off")
+#endif
+
+#include "PathKernels.h"
+#include "PowerBasis.h"
+
+#include <cmath>
+
+#if defined(SIMPLIFYQT_HAVE_AVX2) || defined(SIMPLIFYQT_HAVE_AVX512)
+#  include <immintrin.h>
+#endif
+
+namespace SimplifyQt {
+
+Q_STATIC_ASSERT(sizeof(QPointF) == 2 * sizeof(qreal));
+
+/*****************************************************************************
+  Portable kernels
+ *****************************************************************************/
+
+static inline void accumulate(qreal *lengths, int count)
+{
+    // Sequential on purpose, a tree-shaped sum would round differently.
+    lengths[0] = 0.0;
+    for (int i = 1; i < count; ++i) {
+        lengths[i] += lengths[i - 1];
+    }
+}
+
+static void chordLengthsGeneric(const qreal *x, const qreal *y, int count, qreal *lengths)
+{
+    for (int i = 1; i < count; ++i) {
+        qreal dx = x[i] - x[i - 1];
+        qreal dy = y[i] - y[i - 1];
+        lengths[i] = std::sqrt(dx * dx + dy * dy);
+    }
+    accumulate(lengths, count);
+}
+
+static void loadPointsGeneric(const QPointF *points, int count, qreal *x, qreal *y, qreal *lengths)
+{
+    for (int i = 0; i < count; ++i) {
+        x[i] = points[i].x();
+        y[i] = points[i].y();
+    }
+    chordLengthsGeneric(x, y, count, lengths);
+}
+
+static void chordLengthParameterizeGeneric(const qreal *lengths, int count, qreal *u)
+{
+    qreal base = lengths[0];
+    qreal length = lengths[count - 1] - base;
+    u[0] = 0.0;
+    for (int i = 1; i < count; ++i) {
+        u[i] = (lengths[i] - base) / length;
+    }
+}
+
+static QPair<qreal, int> findMaxErrorGeneric(const qreal *x, const qreal *y, const qreal *u, int count, const QPointF *curves)
+{
+    const PowerBasis<3> c = powerBasis<3>(curves);
+
+    qreal maxDist = 0.0;
+    int index = -1;
+    for (int i = 1; i < count - 1; ++i) {
+        QPointF P = evaluate(c, u[i]);
+        QPointF v = P - QPointF(x[i], y[i]);
+        qreal dist = v.x() * v.x() + v.y() * v.y();
+        if (dist >= maxDist) {
+            maxDist = dist;
+            index = i;
+        }
+    }
+
+    return QPair<qreal, int>(maxDist, index);
+}
+
+static const PathKernels kernelsGeneric = {
+    "generic", SimdNone,
+    loadPointsGeneric,
+    chordLengthsGeneric,
+    chordLengthParameterizeGeneric,
+    findMaxErrorGeneric
+};
+
+/*****************************************************************************
+  SSE2 kernels
+ *****************************************************************************/
+
+#if defined(SIMPLIFYQT_HAVE_SSE2)
+
+static void chordLengthsSse2(const qreal *x, const qreal *y, int count, qreal *lengths)
+{
+    int i = 1;
+    for (; i + 1 < count; i += 2) {
+        __m128d dx = _mm_sub_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(x + i - 1));
+        __m128d dy = _mm_sub_pd(_mm_loadu_pd(y + i), _mm_loadu_pd(y + i - 1));
+        _mm_storeu_pd(lengths + i, _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy))));
+    }
+    for (; i < count; ++i) {
+        qreal dx = x[i] - x[i - 1];
+        qreal dy = y[i] - y[i - 1];
+        lengths[i] = std::sqrt(dx * dx + dy * dy);
+    }
+
+    accumulate(lengths, count);
+}
+
+static void loadPointsSse2(const QPointF *points, int count, qreal *x, qreal *y, qreal *lengths)
+{
+    const double *p = reinterpret_cast<const double *>(points);
+
+    int i = 0;
+    for (; i + 1 < count; i += 2) {
+        __m128d a = _mm_loadu_pd(p + 2 * i);
+        __m128d b = _mm_loadu_pd(p + 2 * i + 2);
+        _mm_storeu_pd(x + i, _mm_unpacklo_pd(a, b));
+        _mm_storeu_pd(y + i, _mm_unpackhi_pd(a, b));
+    }
+    for (; i < count; ++i) {
+        x[i] = p[2 * i];
+        y[i] = p[2 * i + 1];
+    }
+
+    chordLengthsSse2(x, y, count, lengths);
+}
+
+static void chordLengthParameterizeSse2(const qreal *lengths, int count, qreal *u)
+{
+    qreal base = lengths[0];
+    qreal length = lengths[count - 1] - base;
+    const __m128d vbase = _mm_set1_pd(base);
+    const __m128d vlength = _mm_set1_pd(length);
+
+    u[0] = 0.0;
+    int i = 1;
+    for (; i + 1 < count; i += 2) {
+        _mm_storeu_pd(u + i, _mm_div_pd(_mm_sub_pd(_mm_loadu_pd(lengths + i), vbase), vlength));
+    }
+    for (; i < count; ++i) {
+        u[i] = (lengths[i] - base) / length;
+    }
+}
+
+static QPair<qreal, int> findMaxErrorSse2(const qreal *x, const qreal *y, const qreal *u, int count, const QPointF *curves)
+{
+    // Two parameters per register, no FMA: every distance rounds like the
+    // generic kernel's, and the scan over them stays sequential.
+
+    const PowerBasis<3> c = powerBasis<3>(curves);
+
+    __m128d cx[4];
+    __m128d cy[4];
+    for (int k = 0; k < 4; ++k) {
+        cx[k] = _mm_set1_pd(c.x[k]);
+        cy[k] = _mm_set1_pd(c.y[k]);
+    }
+
+    qreal maxDist = 0.0;
+    int index = -1;
+    int i = 1;
+    for (; i + 1 < count - 1; i += 2) {
+        __m128d t = _mm_loadu_pd(u + i);
+
+        __m128d vx = _mm_sub_pd(evaluate<3>(cx, t), _mm_loadu_pd(x + i));
+        __m128d vy = _mm_sub_pd(evaluate<3>(cy, t), _mm_loadu_pd(y + i));
+        __m128d dist = _mm_add_pd(_mm_mul_pd(vx, vx), _mm_mul_pd(vy, vy));
+
+        double laneDist[2];
+        _mm_storeu_pd(laneDist, dist);
+        for (int k = 0; k < 2; ++k) {
+            if (laneDist[k] >= maxDist) {
+                maxDist = laneDist[k];
+                index = i + k;
+            }
+        }
+    }
+    for (; i < count - 1; ++i) {
+        QPointF v = evaluate(c, u[i]) - QPointF(x[i], y[i]);
+        qreal dist = v.x() * v.x() + v.y() * v.y();
+        if (dist >= maxDist) {
+            maxDist = dist;
+            index = i;
+        }
+    }
+
+    return QPair<qreal, int>(maxDist, index);
+}
+
+static const PathKernels kernelsSse2 = {
+    "sse2", SimdSse2,
+    loadPointsSse2,
+    chordLengthsSse2,
+    chordLengthParameterizeSse2,
+    findMaxErrorSse2
+};
+
+#endif // SIMPLIFYQT_HAVE_SSE2
+
+/*****************************************************************************
+  AVX2 + FMA kernels
+ *****************************************************************************/
+
+#if defined(SIMPLIFYQT_HAVE_AVX2)
+
+// No FMA in the target of the exact kernels.
+SIMPLIFYQT_FUNCTION_TARGET("avx2")
+static void chordLengthsAvx2(const qreal *x, const qreal *y, int count, qreal *lengths)
+{
+    int i = 1;
+    for (; i + 3 < count; i += 4) {
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(x + i - 1));
+        __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y + i), _mm256_loadu_pd(y + i - 1));
+        _mm256_storeu_pd(lengths + i, _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy))));
+    }
+    for (; i < count; ++i) {
+        qreal dx = x[i] - x[i - 1];
+        qreal dy = y[i] - y[i - 1];
+        lengths[i] = std::sqrt(dx * dx + dy * dy);
+    }
+
+    accumulate(lengths, count);
+}
+
+SIMPLIFYQT_FUNCTION_TARGET("avx2")
+static void loadPointsAvx2(const QPointF *points, int count, qreal *x, qreal *y, qreal *lengths)
+{
+    const double *p = reinterpret_cast<const double *>(points);
+
+    int i = 0;
+    for (; i + 3 < count; i += 4) {
+        __m256d a = _mm256_loadu_pd(p + 2 * i);
+        __m256d b = _mm256_loadu_pd(p + 2 * i + 4);
+        _mm256_storeu_pd(x + i, _mm256_permute4x64_pd(_mm256_unpacklo_pd(a, b), 0xd8));
+        _mm256_storeu_pd(y + i, _mm256_permute4x64_pd(_mm256_unpackhi_pd(a, b), 0xd8));
+    }
+    for (; i < count; ++i) {
+        x[i] = p[2 * i];
+        y[i] = p[2 * i + 1];
+    }
+
+    chordLengthsAvx2(x, y, count, lengths);
+}
+
+SIMPLIFYQT_FUNCTION_TARGET("avx2")
+static void chordLengthParameterizeAvx2(const qreal *lengths, int count, qreal *u)
+{
+    qreal base = lengths[0];
+    qreal length = lengths[count - 1] - base;
+    const __m256d vbase = _mm256_set1_pd(base);
+    const __m256d vlength = _mm256_set1_pd(length);
+
+    u[0] = 0.0;
+    int i = 1;
+    for (; i + 3 < count; i += 4) {
+        _mm256_storeu_pd(u + i, _mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(lengths + i), vbase), vlength));
+    }
+    for (; i < count; ++i) {
+        u[i] = (lengths[i] - base) / length;
+    }
+}
+
+template <int Degree>
+struct Horner<Degree, __m256d>
+{
+    SIMPLIFYQT_FUNCTION_TARGET("avx2,fma")
+    static inline __m256d evaluate(const __m256d *c, __m256d t)
+    {
+        __m256d r = c[Degree];
+        for (int k = Degree - 1; k >= 0; --k) {
+            r = _mm256_fmadd_pd(r, t, c[k]);
+        }
+        return r;
+    }
+};
+
+SIMPLIFYQT_FUNCTION_TARGET("avx2,fma")
+static QPair<qreal, int> findMaxErrorAvx2(const qreal *x, const qreal *y, const qreal *u, int count, const QPointF *curves)
+{
+    // Four parameters per register, the running maximum and its index stay
+    // in registers per lane.
+
+    const PowerBasis<3> c = powerBasis<3>(curves);
+
+    __m256d cx[4];
+    __m256d cy[4];
+    for (int k = 0; k < 4; ++k) {
+        cx[k] = _mm256_set1_pd(c.x[k]);
+        cy[k] = _mm256_set1_pd(c.y[k]);
+    }
+
+    __m256d maxDist = _mm256_setzero_pd();
+    __m256d maxIndex = _mm256_set1_pd(-1.0);
+    __m256d index = _mm256_setr_pd(1.0, 2.0, 3.0, 4.0);
+    const __m256d step = _mm256_set1_pd(4.0);
+
+    int i = 1;
+    for (; i + 3 < count - 1; i += 4) {
+        __m256d t = _mm256_loadu_pd(u + i);
+
+        __m256d vx = _mm256_sub_pd(Horner<3, __m256d>::evaluate(cx, t), _mm256_loadu_pd(x + i));
+        __m256d vy = _mm256_sub_pd(Horner<3, __m256d>::evaluate(cy, t), _mm256_loadu_pd(y + i));
+        __m256d dist = _mm256_add_pd(_mm256_mul_pd(vx, vx), _mm256_mul_pd(vy, vy));
+
+        __m256d ge = _mm256_cmp_pd(dist, maxDist, _CMP_GE_OQ);
+        maxDist = _mm256_blendv_pd(maxDist, dist, ge);
+        maxIndex = _mm256_blendv_pd(maxIndex, index, ge);
+        index = _mm256_add_pd(index, step);
+    }
+
+    // The largest distance wins, ties go to the highest index like the
+    // sequential scan; the tail then continues that scan.
+    double laneDist[4];
+    double laneIndex[4];
+    _mm256_storeu_pd(laneDist, maxDist);
+    _mm256_storeu_pd(laneIndex, maxIndex);
+
+    qreal max = laneDist[0];
+    int maxAt = int(laneIndex[0]);
+    for (int k = 1; k < 4; ++k) {
+        if ((laneDist[k] > max) || ((laneDist[k] == max) && (int(laneIndex[k]) > maxAt))) {
+            max = laneDist[k];
+            maxAt = int(laneIndex[k]);
+        }
+    }
+
+    for (; i < count - 1; ++i) {
+        __m256d t = _mm256_set1_pd(u[i]);
+        qreal vx = _mm256_cvtsd_f64(Horner<3, __m256d>::evaluate(cx, t)) - x[i];
+        qreal vy = _mm256_cvtsd_f64(Horner<3, __m256d>::evaluate(cy, t)) - y[i];
+        qreal dist = vx * vx + vy * vy;
+        if (dist >= max) {
+            max = dist;
+            maxAt = i;
+        }
+    }
+
+    return QPair<qreal, int>(max, maxAt);
+}
+
+static const PathKernels kernelsAvx2 = {
+    "avx2", SimdAvx2,
+    loadPointsAvx2,
+    chordLengthsAvx2,
+    chordLengthParameterizeAvx2,
+    findMaxErrorAvx2
+};
+
+#endif // SIMPLIFYQT_HAVE_AVX2
+
+/*****************************************************************************
+  AVX-512 kernels
+ *****************************************************************************/
+
+#if defined(SIMPLIFYQT_HAVE_AVX512)
+
+// AVX-512F has FMA built in, only the contraction pragmas above keep the
+// exact kernels from fusing.
+SIMPLIFYQT_FUNCTION_TARGET("avx512f")
+static void chordLengthsAvx512(const qreal *x, const qreal *y, int count, qreal *lengths)
+{
+    for (int i = 1; i < count; i += 8) {
+        __mmask8 mask = __mmask8((1u << qMin(8, count - i)) - 1);
+        __m512d dx = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, x + i), _mm512_maskz_loadu_pd(mask, x + i - 1));
+        __m512d dy = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, y + i), _mm512_maskz_loadu_pd(mask, y + i - 1));
+        _mm512_mask_storeu_pd(lengths + i, mask, _mm512_sqrt_pd(_mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy))));
+    }
+
+    accumulate(lengths, count);
+}
+
+SIMPLIFYQT_FUNCTION_TARGET("avx512f")
+static void loadPointsAvx512(const QPointF *points, int count, qreal *x, qreal *y, qreal *lengths)
+{
+    const double *p = reinterpret_cast<const double *>(points);
+    const __m512i evens = _mm512_setr_epi64(0, 2, 4, 6, 8, 10, 12, 14);
+    const __m512i odds = _mm512_setr_epi64(1, 3, 5, 7, 9, 11, 13, 15);
+
+    int i = 0;
+    for (; i + 7 < count; i += 8) {
+        __m512d a = _mm512_loadu_pd(p + 2 * i);
+        __m512d b = _mm512_loadu_pd(p + 2 * i + 8);
+        _mm512_storeu_pd(x + i, _mm512_permutex2var_pd(a, evens, b));
+        _mm512_storeu_pd(y + i, _mm512_permutex2var_pd(a, odds, b));
+    }
+    for (; i < count; ++i) {
+        x[i] = p[2 * i];
+        y[i] = p[2 * i + 1];
+    }
+
+    chordLengthsAvx512(x, y, count, lengths);
+}
+
+SIMPLIFYQT_FUNCTION_TARGET("avx512f")
+static void chordLengthParameterizeAvx512(const qreal *lengths, int count, qreal *u)
+{
+    qreal base = lengths[0];
+    qreal length = lengths[count - 1] - base;
+    const __m512d vbase = _mm512_set1_pd(base);
+    const __m512d vlength = _mm512_set1_pd(length);
+
+    u[0] = 0.0;
+    for (int i = 1; i < count; i += 8) {
+        __mmask8 mask = __mmask8((1u << qMin(8, count - i)) - 1);
+        __m512d v = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, lengths + i), vbase);
+        _mm512_mask_storeu_pd(u + i, mask, _mm512_div_pd(v, vlength));
+    }
+}
+
+template <int Degree>
+struct Horner<Degree, __m512d>
+{
+    SIMPLIFYQT_FUNCTION_TARGET("avx512f")
+    static inline __m512d evaluate(const __m512d *c, __m512d t)
+    {
+        __m512d r = c[Degree];
+        for (int k = Degree - 1; k >= 0; --k) {
+            r = _mm512_fmadd_pd(r, t, c[k]);
+        }
+        return r;
+    }
+};
+
+SIMPLIFYQT_FUNCTION_TARGET("avx512f")
+static QPair<qreal, int> findMaxErrorAvx512(const qreal *x, const qreal *y, const qreal *u, int count, const QPointF *curves)
+{
+    // Eight parameters per register. The tail is a masked iteration,
+    // masked-out lanes never win.
+
+    const PowerBasis<3> c = powerBasis<3>(curves);
+
+    __m512d cx[4];
+    __m512d cy[4];
+    for (int k = 0; k < 4; ++k) {
+        cx[k] = _mm512_set1_pd(c.x[k]);
+        cy[k] = _mm512_set1_pd(c.y[k]);
+    }
+
+    const __m512i step = _mm512_set1_epi64(8);
+
+    __m512d maxDist = _mm512_setzero_pd();
+    __m512i maxIndex = _mm512_set1_epi64(-1);
+    __m512i index = _mm512_setr_epi64(1, 2, 3, 4, 5, 6, 7, 8);
+
+    for (int i = 1; i < count - 1; i += 8) {
+        int n = qMin(8, count - 1 - i);
+        __mmask8 mask = __mmask8((1u << n) - 1);
+
+        __m512d t = _mm512_maskz_loadu_pd(mask, u + i);
+
+        __m512d vx = _mm512_sub_pd(Horner<3, __m512d>::evaluate(cx, t), _mm512_maskz_loadu_pd(mask, x + i));
+        __m512d vy = _mm512_sub_pd(Horner<3, __m512d>::evaluate(cy, t), _mm512_maskz_loadu_pd(mask, y + i));
+        __m512d dist = _mm512_add_pd(_mm512_mul_pd(vx, vx), _mm512_mul_pd(vy, vy));
+
+        __mmask8 ge = _mm512_mask_cmp_pd_mask(mask, dist, maxDist, _CMP_GE_OQ);
+        maxDist = _mm512_mask_mov_pd(maxDist, ge, dist);
+        maxIndex = _mm512_mask_mov_epi64(maxIndex, ge, index);
+        index = _mm512_add_epi64(index, step);
+    }
+
+    // The largest distance wins, ties go to the highest index like the
+    // sequential scan.
+    double laneDist[8];
+    qint64 laneIndex[8];
+    _mm512_storeu_pd(laneDist, maxDist);
+    _mm512_storeu_si512(laneIndex, maxIndex);
+
+    qreal max = laneDist[0];
+    int maxAt = int(laneIndex[0]);
+    for (int k = 1; k < 8; ++k) {
+        if ((laneDist[k] > max) || ((laneDist[k] == max) && (int(laneIndex[k]) > maxAt))) {
+            max = laneDist[k];
+            maxAt = int(laneIndex[k]);
+        }
+    }
+
+    return QPair<qreal, int>(max, maxAt);
+}
+
+static const PathKernels kernelsAvx512 = {
+    "avx512", SimdAvx512,
+    loadPointsAvx512,
+    chordLengthsAvx512,
+    chordLengthParameterizeAvx512,
+    findMaxErrorAvx512
+};
+
+#endif // SIMPLIFYQT_HAVE_AVX512
+
+/*****************************************************************************
+  Dispatch
+ *****************************************************************************/
+
+static SimdLevel supportedSimdLevel()
+{
+    static const SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+const PathKernels *pathKernels(SimdLevel level)
+{
+    if (level > supportedSimdLevel())
+        return nullptr;
+
+    switch (level) {
+    case SimdNone:
+        return &kernelsGeneric;
+#if defined(SIMPLIFYQT_HAVE_SSE2)
+    case SimdSse2:
+        return &kernelsSse2;
+#endif
+#if defined(SIMPLIFYQT_HAVE_AVX2)
+    case SimdAvx2:
+        return &kernelsAvx2;
+#endif
+#if defined(SIMPLIFYQT_HAVE_AVX512)
+    case SimdAvx512:
+        return &kernelsAvx512;
+#endif
+    default:
+        break;
+    }
+
+    return nullptr;
+}
+
+const PathKernels &bestPathKernels()
+{
+    static const PathKernels *best = [] {
+        for (int level = supportedSimdLevel(); level > SimdNone; --level) {
+            if (const PathKernels *kernels = pathKernels(SimdLevel(level)))
+                return kernels;
+        }
+        return &kernelsGeneric;
+    }();
+
+    return *best;
+}
+
+} // namespace SimplifyQt
@@ -0,0 +1,101 @@
+#ifndef PATHKERNELS_H
+#define PATHKERNELS_H
+
+#include <QPair>
+#include <QPointF>
+
+#include "CpuFeatures.h"
+
+namespace SimplifyQt {
+
+struct PathKernels
+{
+    const char *name;
+    SimdLevel   level;
+
+    // Splits points into x and y and stores the cumulative chord length from
+    // the first point in lengths. Rounds exactly like the scalar code.
+    void (*loadPoints)(const QPointF *points, int count, qreal *x, qreal *y, qreal *lengths);
+
+    // The lengths part of loadPoints, for points already split into x and y.
+    void (*chordLengths)(const qreal *x, const qreal *y, int count, qreal *lengths);
+
+    // Chord-length parameters of a span from its slice of the cumulative
+    // lengths: u[0] = 0, u[count - 1] = 1. Rounds exactly like the scalar code.
+    void (*chordLengthParameterize)(const qreal *lengths, int count, qreal *u);
+
+    // Squared distance between the cubic `curves` evaluated at u[i] and the
+    // point (x[i], y[i]) for 0 < i < count - 1. Returns the largest one and its
+    // index, the last index wins on ties; the index is -1 when no distance
+    // compared >= 0.
+    QPair<qreal, int> (*findMaxError)(const qreal *x, const qreal *y, const qreal *u, int count, const QPointF *curves);
+};
+
+// Kernels of the given level, nullptr if this build or this CPU cannot run them.
+const PathKernels *pathKernels(SimdLevel level);
+
+// Kernels of the highest level the CPU supports, chosen once on first use.
+const PathKernels &bestPathKernels();
+
+#if !defined(QT_COORD_TYPE)
+
+// Single-precision kernels: x, y and u are float, the cumulative lengths stay
+// qreal so that spans far into a long polyline still get exact parameters.
+// Twice the lanes of the qreal kernels at every level.
+struct PathKernelsF
+{
+    const char *name;
+    SimdLevel   level;
+
+    // Splits points into x and y less origin, rounded to float, and stores
+    // the cumulative chord length of the rounded points in lengths. Every
+    // level fills the arrays bit-for-bit the same.
+    void (*loadPoints)(const QPointF *points, int count, const QPointF &origin, float *x, float *y, qreal *lengths);
+
+    // The lengths part of loadPoints, for points already split into x and y.
+    void (*chordLengths)(const float *x, const float *y, int count, qreal *lengths);
+
+    // As PathKernels::chordLengthParameterize(), rounded to float at the end.
+    void (*chordLengthParameterize)(const qreal *lengths, int count, float *u);
+
+    // As PathKernels::findMaxError(), evaluated in float.
+    QPair<qreal, int> (*findMaxError)(const float *x, const float *y, const float *u, int count, const QPointF *curves);
+};
+
+const PathKernelsF *pathKernelsF(SimdLevel level);
+const PathKernelsF &bestPathKernelsF();
+
+#endif // !QT_COORD_TYPE
+
+// What the fitter templates need to know about their scalar type. Float
+// points are recentred on the first one, the fitter works in those local
+// coordinates and moves its output back. With -qreal float the qreal traits
+// are the only ones.
+template <typename Real>
+struct PathTraits;
+
+template <>
+struct PathTraits<qreal>
+{
+    typedef PathKernels Kernels;
+    enum { Recenter = false };
+
+    static inline const Kernels &generic() { return *pathKernels(SimdNone); }
+    static inline const Kernels &best() { return bestPathKernels(); }
+};
+
+#if !defined(QT_COORD_TYPE)
+template <>
+struct PathTraits<float>
+{
+    typedef PathKernelsF Kernels;
+    enum { Recenter = true };
+
+    static inline const Kernels &generic() { return *pathKernelsF(SimdNone); }
+    static inline const Kernels &best() { return bestPathKernelsF(); }
+};
+#endif
+
+} // namespace SimplifyQt
+
+#endif // PATHKERNELS_H
@@ -0,0 +1,582 @@
+// Same as PathKernels.cpp: no implicit FMA, the loaders have to round the
+// same at every level.
+#if defined(__clang__)
+#  pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#  pragma GCC optimize ("fp-contract=off")
+#endif
+
+#include "PathKernels.h"
+#include "PowerBasis.h"
+
+#include <cmath>
+
+#if defined(SIMPLIFYQT_HAVE_SSE2)
+#  include <emmintrin.h>
+#endif
+#if defined(SIMPLIFYQT_HAVE_AVX2) || defined(SIMPLIFYQT_HAVE_AVX512)
+#  include <immintrin.h>
+#endif
+
+// With -qreal float the qreal kernels are the float ones.
+#if !defined(QT_COORD_TYPE)
+
+namespace SimplifyQt {
+
+Q_STATIC_ASSERT(sizeof(QPointF) == 2 * sizeof(double));
+
+/*****************************************************************************
+  Portable kernels
+ *****************************************************************************/
+
+static inline void accumulate(qreal *lengths, int count)
+{
+    // Sequential and in qreal, the float chords only round once each.
+    lengths[0] = 0.0;
+    for (int i = 1; i < count; ++i) {
+        lengths[i] += lengths[i - 1];
+    }
+}
+
+static inline qreal chordLength(const float *x, const float *y, int i)
+{
+    float dx = x[i] - x[i - 1];
+    float dy = y[i] - y[i - 1];
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+static void chordLengthsGeneric(const float *x, const float *y, int count, qreal *lengths)
+{
+    for (int i = 1; i < count; ++i) {
+        lengths[i] = chordLength(x, y, i);
+    }
+    accumulate(lengths, count);
+}
+
+static void loadPointsGeneric(const QPointF *points, int count, const QPointF &origin, float *x, float *y, qreal *lengths)
+{
+    for (int i = 0; i < count; ++i) {
+        x[i] = float(points[i].x() - origin.x());
+        y[i] = float(points[i].y() - origin.y());
+    }
+    chordLengthsGeneric(x, y, count, lengths);
+}
+
+static void chordLengthParameterizeGeneric(const qreal *lengths, int count, float *u)
+{
+    qreal base = lengths[0];
+    qreal length = lengths[count - 1] - base;
+    u[0] = 0.0f;
+    for (int i = 1; i < count; ++i) {
+        u[i] = float((lengths[i] - base) / length);
+    }
+}
+
+static QPair<qreal, int> findMaxErrorGeneric(const float *x, const float *y, const float *u, int count, const QPointF *curves)
+{
+    const PowerBasis<3, float> c = powerBasis<3, float>(curves);
+
+    float maxDist = 0.0f;
+    int index = -1;
+    for (int i = 1; i < count - 1; ++i) {
+        float vx = evaluate<3>(c.x, u[i]) - x[i];
+        float vy = evaluate<3>(c.y, u[i]) - y[i];
+        float dist = vx * vx + vy * vy;
+        if (dist >= maxDist) {
+            maxDist = dist;
+            index = i;
+        }
+    }
+
+    return QPair<qreal, int>(maxDist, index);
+}
+
+// The largest distance wins, ties go to the highest index like the
+// sequential scan.
+static inline void reduceLanes(const float *laneDist, const qint32 *laneIndex, int lanes, float *max, int *maxAt)
+{
+    *max = laneDist[0];
+    *maxAt = laneIndex[0];
+    for (int k = 1; k < lanes; ++k) {
+        if ((laneDist[k] > *max) || ((laneDist[k] == *max) && (laneIndex[k] > *maxAt))) {
+            *max = laneDist[k];
+            *maxAt = laneIndex[k];
+        }
+    }
+}
+
+static const PathKernelsF kernelsGeneric = {
+    "generic", SimdNone,
+    loadPointsGeneric,
+    chordLengthsGeneric,
+    chordLengthParameterizeGeneric,
+    findMaxErrorGeneric
+};
+
+/*****************************************************************************
+  SSE2 kernels
+ *****************************************************************************/
+
+#if defined(SIMPLIFYQT_HAVE_SSE2)
+
+static void chordLengthsSse2(const float *x, const float *y, int count, qreal *lengths)
+{
+    int i = 1;
+    for (; i + 3 < count; i += 4) {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(x + i - 1));
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(y + i), _mm_loadu_ps(y + i - 1));
+        __m128 d = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+        _mm_storeu_pd(lengths + i, _mm_cvtps_pd(d));
+        _mm_storeu_pd(lengths + i + 2, _mm_cvtps_pd(_mm_movehl_ps(d, d)));
+    }
+    for (; i < count; ++i) {
+        lengths[i] = chordLength(x, y, i);
+    }
+
+    accumulate(lengths, count);
+}
+
+static void loadPointsSse2(const QPointF *points, int count, const QPointF &origin, float *x, float *y, qreal *lengths)
+{
+    const double *p = reinterpret_cast<const double *>(points);
+    const __m128d o = _mm_set_pd(origin.y(), origin.x());
+
+    int i = 0;
+    for (; i + 3 < count; i += 4) {
+        __m128d a = _mm_sub_pd(_mm_loadu_pd(p + 2 * i), o);
+        __m128d b = _mm_sub_pd(_mm_loadu_pd(p + 2 * i + 2), o);
+        __m128d c = _mm_sub_pd(_mm_loadu_pd(p + 2 * i + 4), o);
+        __m128d d = _mm_sub_pd(_mm_loadu_pd(p + 2 * i + 6), o);
+        _mm_storeu_ps(x + i, _mm_movelh_ps(_mm_cvtpd_ps(_mm_unpacklo_pd(a, b)), _mm_cvtpd_ps(_mm_unpacklo_pd(c, d))));
+        _mm_storeu_ps(y + i, _mm_movelh_ps(_mm_cvtpd_ps(_mm_unpackhi_pd(a, b)), _mm_cvtpd_ps(_mm_unpackhi_pd(c, d))));
+    }
+    for (; i < count; ++i) {
+        x[i] = float(p[2 * i] - origin.x());
+        y[i] = float(p[2 * i + 1] - origin.y());
+    }
+
+    chordLengthsSse2(x, y, count, lengths);
+}
+
+static void chordLengthParameterizeSse2(const qreal *lengths, int count, float *u)
+{
+    qreal base = lengths[0];
+    qreal length = lengths[count - 1] - base;
+    const __m128d vbase = _mm_set1_pd(base);
+    const __m128d vlength = _mm_set1_pd(length);
+
+    u[0] = 0.0f;
+    int i = 1;
+    for (; i + 3 < count; i += 4) {
+        __m128 lo = _mm_cvtpd_ps(_mm_div_pd(_mm_sub_pd(_mm_loadu_pd(lengths + i), vbase), vlength));
+        __m128 hi = _mm_cvtpd_ps(_mm_div_pd(_mm_sub_pd(_mm_loadu_pd(lengths + i + 2), vbase), vlength));
+        _mm_storeu_ps(u + i, _mm_movelh_ps(lo, hi));
+    }
+    for (; i < count; ++i) {
+        u[i] = float((lengths[i] - base) / length);
+    }
+}
+
+static QPair<qreal, int> findMaxErrorSse2(const float *x, const float *y, const float *u, int count, const QPointF *curves)
+{
+    // Four parameters per register, no FMA: rounds like the generic kernel.
+
+    const PowerBasis<3, float> c = powerBasis<3, float>(curves);
+
+    __m128 cx[4];
+    __m128 cy[4];
+    for (int k = 0; k < 4; ++k) {
+        cx[k] = _mm_set1_ps(c.x[k]);
+        cy[k] = _mm_set1_ps(c.y[k]);
+    }
+
+    __m128 maxDist = _mm_setzero_ps();
+    __m128i maxIndex = _mm_set1_epi32(-1);
+    __m128i index = _mm_setr_epi32(1, 2, 3, 4);
+    const __m128i step = _mm_set1_epi32(4);
+
+    int i = 1;
+    for (; i + 3 < count - 1; i += 4) {
+        __m128 t = _mm_loadu_ps(u + i);
+
+        __m128 vx = _mm_sub_ps(evaluate<3>(cx, t), _mm_loadu_ps(x + i));
+        __m128 vy = _mm_sub_ps(evaluate<3>(cy, t), _mm_loadu_ps(y + i));
+        __m128 dist = _mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy));
+
+        __m128 ge = _mm_cmpge_ps(dist, maxDist);
+        __m128i gei = _mm_castps_si128(ge);
+        maxDist = _mm_or_ps(_mm_and_ps(ge, dist), _mm_andnot_ps(ge, maxDist));
+        maxIndex = _mm_or_si128(_mm_and_si128(gei, index), _mm_andnot_si128(gei, maxIndex));
+        index = _mm_add_epi32(index, step);
+    }
+
+    float laneDist[4];
+    qint32 laneIndex[4];
+    _mm_storeu_ps(laneDist, maxDist);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(laneIndex), maxIndex);
+
+    float max;
+    int maxAt;
+    reduceLanes(laneDist, laneIndex, 4, &max, &maxAt);
+
+    for (; i < count - 1; ++i) {
+        float vx = evaluate<3>(c.x, u[i]) - x[i];
+        float vy = evaluate<3>(c.y, u[i]) - y[i];
+        float dist = vx * vx + vy * vy;
+        if (dist >= max) {
+            max = dist;
+            maxAt = i;
+        }
+    }
+
+    return QPair<qreal, int>(max, maxAt);
+}
+
+static const PathKernelsF kernelsSse2 = {
+    "sse2", SimdSse2,
+    loadPointsSse2,
+    chordLengthsSse2,
+    chordLengthParameterizeSse2,
+    findMaxErrorSse2
+};
+
+#endif // SIMPLIFYQT_HAVE_SSE2
+
+/*****************************************************************************
+  AVX2 + FMA kernels
+ *****************************************************************************/
+
+#if defined(SIMPLIFYQT_HAVE_AVX2)
+
+// No FMA in the target of the exact kernels.
+SIMPLIFYQT_FUNCTION_TARGET("avx2")
+static void chordLengthsAvx2(const float *x, const float *y, int count, qreal *lengths)
+{
+    int i = 1;
+    for (; i + 7 < count; i += 8) {
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(x + i - 1));
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(y + i), _mm256_loadu_ps(y + i - 1));
+        __m256 d = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+        _mm256_storeu_pd(lengths + i, _mm256_cvtps_pd(_mm256_castps256_ps128(d)));
+        _mm256_storeu_pd(lengths + i + 4, _mm256_cvtps_pd(_mm256_extractf128_ps(d, 1)));
+    }
+    for (; i < count; ++i) {
+        lengths[i] = chordLength(x, y, i);
+    }
+
+    accumulate(lengths, count);
+}
+
+SIMPLIFYQT_FUNCTION_TARGET("avx2")
+static inline __m128 splitAvx2(__m256d a, __m256d b, bool high)
+{
+    // a and b hold two points each; the x (or y) of all four, in order.
+    __m256d v = high ? _mm256_unpackhi_pd(a, b) : _mm256_unpacklo_pd(a, b);
+    return _mm256_cvtpd_ps(_mm256_permute4x64_pd(v, 0xd8));
+}
+
+SIMPLIFYQT_FUNCTION_TARGET("avx2")
+static void loadPointsAvx2(const QPointF *points, int count, const QPointF &origin, float *x, float *y, qreal *lengths)
+{
+    const double *p = reinterpret_cast<const double *>(points);
+    const __m256d o = _mm256_setr_pd(origin.x(), origin.y(), origin.x(), origin.y());
+
+    int i = 0;
+    for (; i + 7 < count; i += 8) {
+        __m256d a = _mm256_sub_pd(_mm256_loadu_pd(p + 2 * i), o);
+        __m256d b = _mm256_sub_pd(_mm256_loadu_pd(p + 2 * i + 4), o);
+        __m256d c = _mm256_sub_pd(_mm256_loadu_pd(p + 2 * i + 8), o);
+        __m256d d = _mm256_sub_pd(_mm256_loadu_pd(p + 2 * i + 12), o);
+        _mm256_storeu_ps(x + i, _mm256_set_m128(splitAvx2(c, d, false), splitAvx2(a, b, false)));
+        _mm256_storeu_ps(y + i, _mm256_set_m128(splitAvx2(c, d, true), splitAvx2(a, b, true)));
+    }
+    for (; i < count; ++i) {
+        x[i] = float(p[2 * i] - origin.x());
+        y[i] = float(p[2 * i + 1] - origin.y());
+    }
+
+    chordLengthsAvx2(x, y, count, lengths);
+}
+
+SIMPLIFYQT_FUNCTION_TARGET("avx2")
+static void chordLengthParameterizeAvx2(const qreal *lengths, int count, float *u)
+{
+    qreal base = lengths[0];
+    qreal length = lengths[count - 1] - base;
+    const __m256d vbase = _mm256_set1_pd(base);
+    const __m256d vlength = _mm256_set1_pd(length);
+
+    u[0] = 0.0f;
+    int i = 1;
+    for (; i + 7 < count; i += 8) {
+        __m128 lo = _mm256_cvtpd_ps(_mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(lengths + i), vbase), vlength));
+        __m128 hi = _mm256_cvtpd_ps(_mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(lengths + i + 4), vbase), vlength));
+        _mm256_storeu_ps(u + i, _mm256_set_m128(hi, lo));
+    }
+    for (; i < count; ++i) {
+        u[i] = float((lengths[i] - base) / length);
+    }
+}
+
+template <int Degree>
+struct Horner<Degree, __m256>
+{
+    SIMPLIFYQT_FUNCTION_TARGET("avx2,fma")
+    static inline __m256 evaluate(const __m256 *c, __m256 t)
+    {
+        __m256 r = c[Degree];
+        for (int k = Degree - 1; k >= 0; --k) {
+            r = _mm256_fmadd_ps(r, t, c[k]);
+        }
+        return r;
+    }
+};
+
+SIMPLIFYQT_FUNCTION_TARGET("avx2,fma")
+static QPair<qreal, int> findMaxErrorAvx2(const float *x, const float *y, const float *u, int count, const QPointF *curves)
+{
+    // Eight parameters per register, the running maximum and its index stay
+    // in registers per lane.
+
+    const PowerBasis<3, float> c = powerBasis<3, float>(curves);
+
+    __m256 cx[4];
+    __m256 cy[4];
+    for (int k = 0; k < 4; ++k) {
+        cx[k] = _mm256_set1_ps(c.x[k]);
+        cy[k] = _mm256_set1_ps(c.y[k]);
+    }
+
+    __m256 maxDist = _mm256_setzero_ps();
+    __m256i maxIndex = _mm256_set1_epi32(-1);
+    __m256i index = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 8);
+    const __m256i step = _mm256_set1_epi32(8);
+
+    int i = 1;
+    for (; i + 7 < count - 1; i += 8) {
+        __m256 t = _mm256_loadu_ps(u + i);
+
+        __m256 vx = _mm256_sub_ps(Horner<3, __m256>::evaluate(cx, t), _mm256_loadu_ps(x + i));
+        __m256 vy = _mm256_sub_ps(Horner<3, __m256>::evaluate(cy, t), _mm256_loadu_ps(y + i));
+        __m256 dist = _mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy));
+
+        __m256 ge = _mm256_cmp_ps(dist, maxDist, _CMP_GE_OQ);
+        maxDist = _mm256_blendv_ps(maxDist, dist, ge);
+        maxIndex = _mm256_blendv_epi8(maxIndex, index, _mm256_castps_si256(ge));
+        index = _mm256_add_epi32(index, step);
+    }
+
+    float laneDist[8];
+    qint32 laneIndex[8];
+    _mm256_storeu_ps(laneDist, maxDist);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(laneIndex), maxIndex);
+
+    float max;
+    int maxAt;
+    reduceLanes(laneDist, laneIndex, 8, &max, &maxAt);
+
+    for (; i < count - 1; ++i) {
+        float vx = evaluate<3>(c.x, u[i]) - x[i];
+        float vy = evaluate<3>(c.y, u[i]) - y[i];
+        float dist = vx * vx + vy * vy;
+        if (dist >= max) {
+            max = dist;
+            maxAt = i;
+        }
+    }
+
+    return QPair<qreal, int>(max, maxAt);
+}
+
+static const PathKernelsF kernelsAvx2 = {
+    "avx2", SimdAvx2,
+    loadPointsAvx2,
+    chordLengthsAvx2,
+    chordLengthParameterizeAvx2,
+    findMaxErrorAvx2
+};
+
+#endif // SIMPLIFYQT_HAVE_AVX2
+
+/*****************************************************************************
+  AVX-512 kernels
+ *****************************************************************************/
+
+#if defined(SIMPLIFYQT_HAVE_AVX512)
+
+SIMPLIFYQT_FUNCTION_TARGET("avx512f")
+static void chordLengthsAvx512(const float *x, const float *y, int count, qreal *lengths)
+{
+    for (int i = 1; i < count; i += 16) {
+        int n = qMin(16, count - i);
+        __mmask16 mask = __mmask16((1u << n) - 1);
+        __m512 dx = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, x + i), _mm512_maskz_loadu_ps(mask, x + i - 1));
+        __m512 dy = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, y + i), _mm512_maskz_loadu_ps(mask, y + i - 1));
+        __m512 d = _mm512_sqrt_ps(_mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dy, dy)));
+        __m512d lo = _mm512_cvtps_pd(_mm512_castps512_ps256(d));
+        __m512d hi = _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(d), 1)));
+        _mm512_mask_storeu_pd(lengths + i, __mmask8(mask), lo);
+        _mm512_mask_storeu_pd(lengths + i + 8, __mmask8(mask >> 8), hi);
+    }
+
+    accumulate(lengths, count);
+}
+
+SIMPLIFYQT_FUNCTION_TARGET("avx512f")
+static void loadPointsAvx512(const QPointF *points, int count, const QPointF &origin, float *x, float *y, qreal *lengths)
+{
+    const double *p = reinterpret_cast<const double *>(points);
+    const __m512i evens = _mm512_setr_epi64(0, 2, 4, 6, 8, 10, 12, 14);
+    const __m512i odds = _mm512_setr_epi64(1, 3, 5, 7, 9, 11, 13, 15);
+    const __m512d ox = _mm512_set1_pd(origin.x());
+    const __m512d oy = _mm512_set1_pd(origin.y());
+
+    int i = 0;
+    for (; i + 7 < count; i += 8) {
+        __m512d a = _mm512_loadu_pd(p + 2 * i);
+        __m512d b = _mm512_loadu_pd(p + 2 * i + 8);
+        _mm256_storeu_ps(x + i, _mm512_cvtpd_ps(_mm512_sub_pd(_mm512_permutex2var_pd(a, evens, b), ox)));
+        _mm256_storeu_ps(y + i, _mm512_cvtpd_ps(_mm512_sub_pd(_mm512_permutex2var_pd(a, odds, b), oy)));
+    }
+    for (; i < count; ++i) {
+        x[i] = float(p[2 * i] - origin.x());
+        y[i] = float(p[2 * i + 1] - origin.y());
+    }
+
+    chordLengthsAvx512(x, y, count, lengths);
+}
+
+SIMPLIFYQT_FUNCTION_TARGET("avx512f")
+static void chordLengthParameterizeAvx512(const qreal *lengths, int count, float *u)
+{
+    qreal base = lengths[0];
+    qreal length = lengths[count - 1] - base;
+    const __m512d vbase = _mm512_set1_pd(base);
+    const __m512d vlength = _mm512_set1_pd(length);
+
+    // Masked float stores need AVX-512VL, the tail is scalar instead.
+    u[0] = 0.0f;
+    int i = 1;
+    for (; i + 7 < count; i += 8) {
+        __m512d v = _mm512_sub_pd(_mm512_loadu_pd(lengths + i), vbase);
+        _mm256_storeu_ps(u + i, _mm512_cvtpd_ps(_mm512_div_pd(v, vlength)));
+    }
+    for (; i < count; ++i) {
+        u[i] = float((lengths[i] - base) / length);
+    }
+}
+
+template <int Degree>
+struct Horner<Degree, __m512>
+{
+    SIMPLIFYQT_FUNCTION_TARGET("avx512f")
+    static inline __m512 evaluate(const __m512 *c, __m512 t)
+    {
+        __m512 r = c[Degree];
+        for (int k = Degree - 1; k >= 0; --k) {
+            r = _mm512_fmadd_ps(r, t, c[k]);
+        }
+        return r;
+    }
+};
+
+SIMPLIFYQT_FUNCTION_TARGET("avx512f")
+static QPair<qreal, int> findMaxErrorAvx512(const float *x, const float *y, const float *u, int count, const QPointF *curves)
+{
+    // Sixteen parameters per register. The tail is a masked iteration,
+    // masked-out lanes never win.
+
+    const PowerBasis<3, float> c = powerBasis<3, float>(curves);
+
+    __m512 cx[4];
+    __m512 cy[4];
+    for (int k = 0; k < 4; ++k) {
+        cx[k] = _mm512_set1_ps(c.x[k]);
+        cy[k] = _mm512_set1_ps(c.y[k]);
+    }
+
+    const __m512i step = _mm512_set1_epi32(16);
+
+    __m512 maxDist = _mm512_setzero_ps();
+    __m512i maxIndex = _mm512_set1_epi32(-1);
+    __m512i index = _mm512_setr_epi32(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16);
+
+    for (int i = 1; i < count - 1; i += 16) {
+        int n = qMin(16, count - 1 - i);
+        __mmask16 mask = __mmask16((1u << n) - 1);
+
+        __m512 t = _mm512_maskz_loadu_ps(mask, u + i);
+
+        __m512 vx = _mm512_sub_ps(Horner<3, __m512>::evaluate(cx, t), _mm512_maskz_loadu_ps(mask, x + i));
+        __m512 vy = _mm512_sub_ps(Horner<3, __m512>::evaluate(cy, t), _mm512_maskz_loadu_ps(mask, y + i));
+        __m512 dist = _mm512_add_ps(_mm512_mul_ps(vx, vx), _mm512_mul_ps(vy, vy));
+
+        __mmask16 ge = _mm512_mask_cmp_ps_mask(mask, dist, maxDist, _CMP_GE_OQ);
+        maxDist = _mm512_mask_mov_ps(maxDist, ge, dist);
+        maxIndex = _mm512_mask_mov_epi32(maxIndex, ge, index);
+        index = _mm512_add_epi32(index, step);
+    }
+
+    float laneDist[16];
+    qint32 laneIndex[16];
+    _mm512_storeu_ps(laneDist, maxDist);
+    _mm512_storeu_si512(laneIndex, maxIndex);
+
+    float max;
+    int maxAt;
+    reduceLanes(laneDist, laneIndex, 16, &max, &maxAt);
+
+    return QPair<qreal, int>(max, maxAt);
+}
+
+static const PathKernelsF kernelsAvx512 = {
+    "avx512", SimdAvx512,
+    loadPointsAvx512,
+    chordLengthsAvx512,
+    chordLengthParameterizeAvx512,
+    findMaxErrorAvx512
+};
+
+#endif // SIMPLIFYQT_HAVE_AVX512
+
+/*****************************************************************************
+  Dispatch
+ *****************************************************************************/
+
+const PathKernelsF *pathKernelsF(SimdLevel level)
+{
+    // Same levels as the qreal kernels, so the same check.
+    if (!pathKernels(level))
+        return nullptr;
+
+    switch (level) {
+    case SimdNone:
+        return &kernelsGeneric;
+#if defined(SIMPLIFYQT_HAVE_SSE2)
+    case SimdSse2:
+        return &kernelsSse2;
+#endif
+#if defined(SIMPLIFYQT_HAVE_AVX2)
+    case SimdAvx2:
+        return &kernelsAvx2;
+#endif
+#if defined(SIMPLIFYQT_HAVE_AVX512)
+    case SimdAvx512:
+        return &kernelsAvx512;
+#endif
+    default:
+        break;
+    }
+
+    return nullptr;
+}
+
+const PathKernelsF &bestPathKernelsF()
+{
+    static const PathKernelsF *best = pathKernelsF(bestPathKernels().level);
+    return *best;
+}
+
+} // namespace SimplifyQt
+
+#endif // !QT_COORD_TYPE
@@ -0,0 +1,151 @@
+#ifndef PATHPOINTS_H
+#define PATHPOINTS_H
+
+#include <QVector>
+#include <QPointF>
+
+#include "../SimplifyQt.h"
+
+#include "PathKernels.h"
+
+namespace SimplifyQt {
+
+template <typename Real>
+class BasicPathPoints
+{
+public:
+    typedef typename PathTraits<Real>::Kernels Kernels;
+
+    // Structure-of-arrays copy of a polyline: x, y and the cumulative chord
+    // length from the first point, each array 64-byte aligned. Every kernel
+    // level fills the arrays bit-for-bit the same.
+    BasicPathPoints()
+        : _count(0)
+        , _capacity(0)
+        , _data(nullptr)
+        , _x(nullptr)
+        , _y(nullptr)
+        , _lengths(nullptr) {
+    }
+
+    explicit BasicPathPoints(const PointSpan &points, const Kernels &kernels = PathTraits<Real>::generic())
+        : _count(0)
+        , _capacity(0)
+        , _data(nullptr)
+        , _x(nullptr)
+        , _y(nullptr)
+        , _lengths(nullptr) {
+        assign(points, kernels);
+    }
+
+    ~BasicPathPoints()
+    {
+        qFreeAligned(_data);
+    }
+
+public:
+    // Replaces the points, reusing the arrays when they are large enough.
+    // A QPointF array is split by the kernels, any other layout is gathered
+    // element by element; either way the arrays come out the same.
+    void assign(const PointSpan &points, const Kernels &kernels = PathTraits<Real>::generic())
+    {
+        int count = points.count();
+        reserve(count);
+
+        _count = count;
+        _origin = (PathTraits<Real>::Recenter && (count > 0)) ? points.at(0) : QPointF();
+        if (count == 0) {
+            return;
+        }
+
+        if (points.isPoints()) {
+            load(kernels, points.points());
+            return;
+        }
+
+        if (points.type() == PointSpan::Float) {
+            gather(static_cast<const float *>(points.xData()), static_cast<const float *>(points.yData()), points.stride());
+        } else {
+            gather(static_cast<const qreal *>(points.xData()), static_cast<const qreal *>(points.yData()), points.stride());
+        }
+        kernels.chordLengths(_x, _y, count, _lengths);
+    }
+
+    // Makes room for count points; the points held are lost if the arrays
+    // have to grow.
+    void reserve(int count)
+    {
+        if (count > _capacity) {
+            // A multiple of 64 bytes per array keeps all three aligned.
+            int stride = (count + 15) & ~15;
+            qFreeAligned(_data);
+            _data = static_cast<char *>(qMallocAligned(stride * (2 * sizeof(Real) + sizeof(qreal)), 64));
+            Q_CHECK_PTR(_data);
+            _capacity = stride;
+            _count = 0;
+            _x = reinterpret_cast<Real *>(_data);
+            _y = _x + stride;
+            _lengths = reinterpret_cast<qreal *>(_y + stride);
+        }
+    }
+
+    inline int count() const { return _count; }
+    inline int capacity() const { return _capacity; }
+    inline bool isEmpty() const { return _count == 0; }
+
+    // Points in the fitter's coordinates, less origin().
+    inline QPointF at(int i) const { return QPointF(_x[i], _y[i]); }
+    inline QPointF first() const { return at(0); }
+    inline QPointF last() const { return at(_count - 1); }
+
+    inline const Real *x() const { return _x; }
+    inline const Real *y() const { return _y; }
+    inline const qreal *lengths() const { return _lengths; }
+
+    // Where the local coordinates start, the null point unless recentred.
+    inline const QPointF &origin() const { return _origin; }
+
+private:
+    void load(const PathKernels &kernels, const QPointF *points)
+    {
+        kernels.loadPoints(points, _count, _x, _y, _lengths);
+    }
+
+#if !defined(QT_COORD_TYPE)
+    void load(const PathKernelsF &kernels, const QPointF *points)
+    {
+        kernels.loadPoints(points, _count, _origin, _x, _y, _lengths);
+    }
+#endif
+
+    template <typename T>
+    void gather(const T *x, const T *y, int stride)
+    {
+        const qreal ox = _origin.x();
+        const qreal oy = _origin.y();
+        for (int i = 0; i < _count; ++i) {
+            _x[i] = Real(x[i * stride] - ox);
+            _y[i] = Real(y[i * stride] - oy);
+        }
+    }
+
+private:
+    Q_DISABLE_COPY(BasicPathPoints)
+
+    int     _count;
+    int     _capacity;
+    char   *_data;
+    Real   *_x;
+    Real   *_y;
+    qreal  *_lengths;
+    QPointF _origin;
+}; // class BasicPathPoints
+
+typedef BasicPathPoints<qreal> PathPoints;
+#if !defined(QT_COORD_TYPE)
+typedef BasicPathPoints<float> PathPointsF;
+#endif
+
+} // namespace SimplifyQt
+
+#endif // PATHPOINTS_H
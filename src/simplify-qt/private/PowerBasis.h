@@ -0,0 +1,136 @@
+#ifndef POWERBASIS_H
+#define POWERBASIS_H
+
+#include <QPointF>
+
+#include "CpuFeatures.h"
+
+#if defined(SIMPLIFYQT_HAVE_SSE2)
+#  include <emmintrin.h>
+#endif
+
+namespace SimplifyQt {
+
+// A Bezier curve of the given degree rewritten as polynomials in t,
+//
+//   x(t) = x[0] + x[1] t + ... + x[Degree] t^Degree
+//
+// and the same for y. PathFitter.js evaluates its curves by de Casteljau,
+// Degree (Degree + 1) lerps per point; once a curve is in this form a point
+// costs Degree multiply-adds per axis. The fitter evaluates one curve at
+// every parameter of a span, so the conversion pays for itself many times.
+template <int Degree, typename Scalar = qreal>
+struct PowerBasis
+{
+    Scalar x[Degree + 1];
+    Scalar y[Degree + 1];
+};
+
+// The coefficients of the curve with control points curve[0..Degree]:
+// x[k] = C(Degree, k) times the k-th forward difference of the control
+// points. Computed in qreal, rounded to Scalar at the end.
+template <int Degree, typename Scalar>
+inline PowerBasis<Degree, Scalar> powerBasis(const QPointF *curve)
+{
+    QPointF differences[Degree + 1];
+    for (int i = 0; i <= Degree; ++i) {
+        differences[i] = curve[i];
+    }
+
+    PowerBasis<Degree, Scalar> basis;
+    qreal binomial = 1;
+    for (int k = 0; k <= Degree; ++k) {
+        basis.x[k] = Scalar(differences[0].x() * binomial);
+        basis.y[k] = Scalar(differences[0].y() * binomial);
+        for (int i = 0; i < Degree - k; ++i) {
+            differences[i] = differences[i + 1] - differences[i];
+        }
+        binomial = binomial * (Degree - k) / (k + 1);
+    }
+
+    return basis;
+}
+
+template <int Degree>
+inline PowerBasis<Degree> powerBasis(const QPointF *curve)
+{
+    return powerBasis<Degree, qreal>(curve);
+}
+
+// The curve's first derivative, one degree lower.
+template <int Degree, typename Scalar>
+inline PowerBasis<Degree - 1, Scalar> derivative(const PowerBasis<Degree, Scalar> &basis)
+{
+    PowerBasis<Degree - 1, Scalar> result;
+    for (int k = 0; k < Degree; ++k) {
+        result.x[k] = basis.x[k + 1] * Scalar(k + 1);
+        result.y[k] = basis.y[k + 1] * Scalar(k + 1);
+    }
+
+    return result;
+}
+
+// Horner's rule on the coefficients c[0..Degree] of one axis. Scalar is a
+// number or a register of them with every coefficient broadcast; the loop
+// count is a constant, so the steps unroll.
+//
+// The primary template and the SSE2 specializations multiply and add
+// separately and round exactly like each other. The kernels that may use
+// FMA specialize it for their own registers, with their target.
+template <int Degree, typename Scalar>
+struct Horner
+{
+    static inline Scalar evaluate(const Scalar *c, Scalar t)
+    {
+        Scalar r = c[Degree];
+        for (int k = Degree - 1; k >= 0; --k) {
+            r = r * t + c[k];
+        }
+        return r;
+    }
+};
+
+#if defined(SIMPLIFYQT_HAVE_SSE2)
+template <int Degree>
+struct Horner<Degree, __m128d>
+{
+    static inline __m128d evaluate(const __m128d *c, __m128d t)
+    {
+        __m128d r = c[Degree];
+        for (int k = Degree - 1; k >= 0; --k) {
+            r = _mm_add_pd(_mm_mul_pd(r, t), c[k]);
+        }
+        return r;
+    }
+};
+
+template <int Degree>
+struct Horner<Degree, __m128>
+{
+    static inline __m128 evaluate(const __m128 *c, __m128 t)
+    {
+        __m128 r = c[Degree];
+        for (int k = Degree - 1; k >= 0; --k) {
+            r = _mm_add_ps(_mm_mul_ps(r, t), c[k]);
+        }
+        return r;
+    }
+};
+#endif
+
+template <int Degree, typename Scalar>
+inline Scalar evaluate(const Scalar *c, Scalar t)
+{
+    return Horner<Degree, Scalar>::evaluate(c, t);
+}
+
+// The point of the curve at t.
+template <int Degree>
+inline QPointF evaluate(const PowerBasis<Degree> &basis, qreal t)
+{
+    return QPointF(evaluate<Degree>(basis.x, t), evaluate<Degree>(basis.y, t));
+}
+
+} // namespace SimplifyQt
+
+#endif // POWERBASIS_H
@@ -0,0 +1,120 @@
+#ifndef SCRATCHARENA_H
+#define SCRATCHARENA_H
+
+#include <QtGlobal>
+#include <QVector>
+
+namespace SimplifyQt {
+
+class ScratchArena
+{
+public:
+    // Stack of qreal buffers for the fitting recursion. Buffers are handed out
+    // and given back in LIFO order, so once the arena has grown to the deepest
+    // demand it never touches the heap again.
+    explicit ScratchArena(int capacity = 0)
+        : used(0) {
+        reserve(capacity);
+    }
+
+    ~ScratchArena()
+    {
+        for (const Block &block : blocks)
+            qFreeAligned(block.data);
+    }
+
+public:
+    class Scope
+    {
+    public:
+        explicit Scope(ScratchArena &arena)
+            : arena(&arena)
+            , mark(arena.used) {
+        }
+
+        ~Scope()
+        {
+            release();
+        }
+
+        void release()
+        {
+            if (arena) {
+                arena->used = mark;
+                arena = nullptr;
+            }
+        }
+
+    private:
+        Q_DISABLE_COPY(Scope)
+
+        ScratchArena *arena;
+        int           mark;
+    };
+
+public:
+    void reserve(int capacity)
+    {
+        if (capacity > this->capacity())
+            grow(capacity - this->capacity());
+    }
+
+    int capacity() const
+    {
+        return blocks.isEmpty() ? 0 : (blocks.last().offset + blocks.last().size);
+    }
+
+    qreal *allocate(int count)
+    {
+        // Offsets run on across blocks, a request never straddles two of them.
+        for (const Block &block : blocks) {
+            if (used < block.offset + block.size) {
+                int start = qMax(used, block.offset);
+                if (start + count <= block.offset + block.size) {
+                    used = start + count;
+                    return block.data + (start - block.offset);
+                }
+            }
+        }
+
+        grow(qMax(count, capacity()));
+        const Block &block = blocks.last();
+        used = block.offset + count;
+        return block.data;
+    }
+
+    // count values of another scalar type, as aligned as a qreal buffer.
+    template <typename T>
+    T *allocate(int count)
+    {
+        return reinterpret_cast<T *>(allocate(int((count * sizeof(T) + sizeof(qreal) - 1) / sizeof(qreal))));
+    }
+
+private:
+    struct Block
+    {
+        qreal *data;
+        int    offset;
+        int    size;
+    };
+
+    void grow(int size)
+    {
+        Block block;
+        block.data = static_cast<qreal *>(qMallocAligned(qMax(size, 64) * sizeof(qreal), 64));
+        Q_CHECK_PTR(block.data);
+        block.offset = capacity();
+        block.size = qMax(size, 64);
+        blocks.append(block);
+    }
+
+private:
+    Q_DISABLE_COPY(ScratchArena)
+
+    QVector<Block> blocks;
+    int            used;
+}; // class ScratchArena
+
+} // namespace SimplifyQt
+
+#endif // SCRATCHARENA_H
@@ -0,0 +1,254 @@
+#ifndef WINDOWEDFIT_H
+#define WINDOWEDFIT_H
+
+#include "../SimplifyQt.h"
+
+#include <QFile>
+
+#include "FitSpan.h"
+
+namespace SimplifyQt {
+
+// A curve as the fitter passes it to a CurveSink, absolute control points.
+struct BufferedCurve
+{
+    QPointF control1;
+    QPointF control2;
+    QPointF endPoint;
+};
+
+} // namespace SimplifyQt
+
+Q_DECLARE_TYPEINFO(SimplifyQt::BufferedCurve, Q_PRIMITIVE_TYPE);
+
+namespace SimplifyQt {
+
+// Keeps the curves of a fit until the window has decided which of them are
+// final, exactly as the fitter computed them: turning them into Segments
+// and back would round every handle against its end point twice.
+class CurveBuffer : public CurveSink
+{
+public:
+    void moveTo(const QPointF &point) Q_DECL_OVERRIDE
+    {
+        Q_UNUSED(point);
+    }
+
+    void cubicTo(const QPointF &control1, const QPointF &control2, const QPointF &endPoint) Q_DECL_OVERRIDE
+    {
+        curves.append(BufferedCurve { control1, control2, endPoint });
+    }
+
+public:
+    QVector<BufferedCurve> curves;
+}; // class CurveBuffer
+
+// Points in memory, as a Source of WindowedFit.
+class SpanSource
+{
+public:
+    explicit SpanSource(const PointSpan &points)
+        : points(points) {
+    }
+
+public:
+    inline qint64 count() const
+    {
+        return points.count();
+    }
+
+    inline bool map(qint64 first, int count, PointSpan *window)
+    {
+        *window = points.mid(int(first), count);
+        return true;
+    }
+
+private:
+    PointSpan points;
+}; // class SpanSource
+
+// Points in a file of interleaved x and y qreals in native byte order, the
+// layout of a QPointF array, as a Source of WindowedFit. Only the window
+// asked for last is mapped, so the address space used does not grow with
+// the file either.
+class MappedPointFile
+{
+public:
+    explicit MappedPointFile(const QString &fileName)
+        : file(fileName)
+        , data(nullptr) {
+    }
+
+    ~MappedPointFile()
+    {
+        unmap();
+    }
+
+public:
+    // False if the file cannot be read or is not a whole number of points.
+    bool open()
+    {
+        return file.open(QIODevice::ReadOnly) && ((file.size() % qint64(sizeof(QPointF))) == 0);
+    }
+
+    inline qint64 count() const
+    {
+        return file.size() / qint64(sizeof(QPointF));
+    }
+
+    bool map(qint64 first, int count, PointSpan *window)
+    {
+        unmap();
+        data = file.map(first * qint64(sizeof(QPointF)), qint64(count) * qint64(sizeof(QPointF)));
+        if (!data)
+            return false;
+
+        *window = PointSpan(reinterpret_cast<const QPointF *>(data), count);
+        return true;
+    }
+
+private:
+    void unmap()
+    {
+        if (data) {
+            file.unmap(data);
+            data = nullptr;
+        }
+    }
+
+private:
+    Q_DISABLE_COPY(MappedPointFile)
+
+    QFile  file;
+    uchar *data;
+}; // class MappedPointFile
+
+// Fits points a window at a time, so memory does not grow with their
+// number: the fitter only ever holds window + 1 points.
+//
+// Each window is fitted as a whole, then its curves are passed to the sink
+// up to the last split that lies at least a margin before the window's end;
+// the curves after it, which saw the window's end as an end of the line,
+// are dropped, and the next window starts at that split. Splits have the
+// tangent of their neighbouring points on both sides, so the next window
+// starts with the direction the last curve ended with and the curves meet
+// without a kink. Every curve is fitted to its own points, so the result
+// stays within the tolerance, but it is not split where Fitter::fit()
+// would split the whole line.
+template <typename Fitter, typename Source>
+class WindowedFit
+{
+public:
+    WindowedFit(Fitter &fitter, Source &source, int window)
+        : fitter(fitter)
+        , source(source)
+        , window(qMax(window, 16))
+        , margin(this->window / 8)
+        , scratch(this->window + 1) {
+        buffer.curves.reserve(this->window);
+        ends.reserve(this->window);
+    }
+
+public:
+    // False if a window of the source could not be read; the curves up to
+    // it have been passed to the sink.
+    bool fit(CurveSink &sink, qreal error)
+    {
+        const qint64 c = source.count();
+        qint64 start = 0;
+        QPointF tan1;
+
+        while (start < c) {
+            const qint64 end = qMin(start + window, c - 1);
+            const int last = int(end - start);
+
+            PointSpan span(static_cast<const QPointF *>(nullptr), 0);
+            if (!source.map(start, last + 1, &span))
+                return false;
+            fitter.setPoints(span);
+            const PathPoints &points = fitter.path();
+
+            if (start == 0) {
+                sink.moveTo(points.first());
+                if (last == 0)
+                    return true;
+                tan1 = points.at(1) - points.at(0);
+            }
+
+            const QPointF tan2 = points.at(last - 1) - points.at(last);
+            fit(error, FitSpan { 0, last, tan1, tan2 });
+            if (end == c - 1) {
+                flush(sink, ends.count());
+                return true;
+            }
+
+            int count = 0;
+            while ((count < ends.count()) && (ends.at(count) <= last - margin))
+                ++count;
+
+            int anchor;
+            if (count > 0) {
+                anchor = ends.at(count - 1);
+            } else {
+                // One curve reaches into the margin: split where the fitter
+                // would, with the tangent of the neighbouring points.
+                anchor = last - margin;
+                fit(error, FitSpan { 0, anchor, tan1, points.at(anchor - 1) - points.at(anchor + 1) });
+                count = ends.count();
+            }
+            flush(sink, count);
+
+            tan1 = points.at(anchor + 1) - points.at(anchor - 1);
+            start += anchor;
+        }
+
+        return true;
+    }
+
+private:
+    void fit(qreal error, FitSpan span)
+    {
+        // Fitter::fitCubic(), noting the point each curve ends at.
+
+        buffer.curves.clear();
+        ends.clear();
+
+        QVector<FitSpan> &spans = scratch.spans;
+        spans.append(span);
+        while (!spans.isEmpty()) {
+            span = spans.last();
+            spans.removeLast();
+
+            FitSpan left;
+            FitSpan right;
+            if (fitter.fitSpan(scratch, buffer, error, span, &left, &right)) {
+                ends.append(span.last);
+            } else {
+                spans.append(right);
+                spans.append(left);
+            }
+        }
+    }
+
+    void flush(CurveSink &sink, int count) const
+    {
+        for (int i = 0; i < count; ++i) {
+            const BufferedCurve &curve = buffer.curves.at(i);
+            sink.cubicTo(curve.control1, curve.control2, curve.endPoint);
+        }
+    }
+
+private:
+    Fitter &fitter;
+    Source &source;
+    int     window;
+    int     margin;
+
+    FitScratch   scratch;
+    CurveBuffer  buffer;
+    QVector<int> ends;
+}; // class WindowedFit
+
+} // namespace SimplifyQt
+
+#endif // WINDOWEDFIT_H
@@ -1,10 +1,41 @@
 INCLUDEPATH += $$PWD
 
+# The portable and SSE2 kernels and the software fitter round bit for bit
+# alike only if no a * b + c is fused behind their back: GCC fuses whenever
+# the target has FMA, clang within an expression by default. Kernels that
+# want FMA use it explicitly.
+gcc|clang: QMAKE_CXXFLAGS += -ffp-contract=off
+
 HEADERS += \
-    $$PWD/SimplifyQt.h
+    $$PWD/FitCache.h \
+    $$PWD/PainterPathSink.h \
+    $$PWD/SegmentCodec.h \
+    $$PWD/Simplifier.h \
+    $$PWD/SimplifyQt.h \
+    $$PWD/StreamingSimplifier.h
 SOURCES += \
-    $$PWD/SimplifyQt.cpp
+    $$PWD/FitCache.cpp \
+    $$PWD/SegmentCodec.cpp \
+    $$PWD/Simplifier.cpp \
+    $$PWD/SimplifyQt.cpp \
+    $$PWD/StreamingSimplifier.cpp
 
 HEADERS += \
+    $$PWD/private/BatchFit.h \
+    $$PWD/private/Corners.h \
+    $$PWD/private/CpuFeatures.h \
+    $$PWD/private/Decimation.h \
+    $$PWD/private/FitSpan.h \
+    $$PWD/private/FitStatsCollector.h \
+    $$PWD/private/LevelFit.h \
+    $$PWD/private/ParallelFit.h \
     $$PWD/private/PathFitterIs.h \
-    $$PWD/private/PathFitterSw.h
+    $$PWD/private/PathFitterSw.h \
+    $$PWD/private/PathKernels.h \
+    $$PWD/private/PathPoints.h \
+    $$PWD/private/PowerBasis.h \
+    $$PWD/private/ScratchArena.h \
+    $$PWD/private/WindowedFit.h
+SOURCES += \
+    $$PWD/private/PathKernels.cpp \
+    $$PWD/private/PathKernelsFloat.cpp
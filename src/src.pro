@@ -1,2 +1,5 @@
 TEMPLATE = subdirs
 CONFIG  += ordered
+
+SUBDIRS += \
+    simplify-cli
@@ -11,4 +11,5 @@ HEADERS += \
 SOURCES += \
     simplifytest.cpp
 
+include(../../common/common.pri)
 include(../../../src/simplify-qt/simplify-qt.pri)
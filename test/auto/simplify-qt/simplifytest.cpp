@@ -0,0 +1,1272 @@
+#include "simplifytest.h"
+
+#include <QtTest>
+#include <QTemporaryFile>
+#include <QThread>
+
+#include "private/Corners.h"
+#include "private/Decimation.h"
+#include "private/FitStatsCollector.h"
+#include "private/ParallelFit.h"
+#include "private/PathFitterIs.h"
+#include "private/PathFitterSw.h"
+#include "private/PathKernels.h"
+#include "private/PathPoints.h"
+#include "private/PowerBasis.h"
+#include "AllocationCounter.h"
+#include "FitCache.h"
+#include "SegmentCodec.h"
+#include "Simplifier.h"
+#include "StreamingSimplifier.h"
+
+// class FitThread
+
+class FitThread : public QThread
+{
+public:
+    explicit FitThread(const QVector<QPointF> &points, bool software)
+        : points(points)
+        , software(software) {
+    }
+
+public:
+    QVector<SimplifyQt::Segment> segments;
+
+protected:
+    void run() Q_DECL_OVERRIDE
+    {
+        segments = software ? SimplifyQt::simplifySw(points) : SimplifyQt::simplifyIs(points);
+    }
+
+private:
+    QVector<QPointF> points;
+    bool software;
+};
+
+// class CacheThread
+
+class CacheThread : public QThread
+{
+public:
+    CacheThread(SimplifyQt::FitCache *cache, const QVector<QVector<QPointF> > *polylines)
+        : cache(cache)
+        , polylines(polylines) {
+    }
+
+public:
+    QVector<QVector<SimplifyQt::Segment> > segments;
+
+protected:
+    void run() Q_DECL_OVERRIDE
+    {
+        for (int i = 0; i < 100; ++i) {
+            for (const QVector<QPointF> &polyline : *polylines) {
+                segments.append(cache->simplifyIs(polyline));
+            }
+        }
+    }
+
+private:
+    SimplifyQt::FitCache *cache;
+    const QVector<QVector<QPointF> > *polylines;
+};
+
+// class SegmentSink
+
+// Curves back as segments, with the handles relative to their end point.
+class SegmentSink : public SimplifyQt::CurveSink
+{
+public:
+    void moveTo(const QPointF &point) Q_DECL_OVERRIDE
+    {
+        segments.append(SimplifyQt::Segment(point));
+    }
+
+    void cubicTo(const QPointF &control1, const QPointF &control2, const QPointF &endPoint) Q_DECL_OVERRIDE
+    {
+        segments.last().setControl2(control1 - segments.last().endPoint());
+        segments.append(SimplifyQt::Segment(endPoint, control2 - endPoint));
+    }
+
+public:
+    QVector<SimplifyQt::Segment> segments;
+};
+
+// The point at t of a curve of the given degree, as PathFitter.js finds it.
+static QPointF deCasteljau(const QPointF *curve, int degree, qreal t)
+{
+    QPointF temp[4];
+    for (int i = 0; i <= degree; ++i) {
+        temp[i] = curve[i];
+    }
+    for (int i = 1; i <= degree; ++i) {
+        for (int j = 0; j <= degree - i; ++j) {
+            temp[j] = temp[j] * (1 - t) + temp[j + 1] * t;
+        }
+    }
+    return temp[0];
+}
+
+// Largest distance between a point and the curve fitted over it, sampled
+// densely; the points must have strictly increasing x.
+static qreal maxDeviation(const QVector<QPointF> &points, const QVector<SimplifyQt::Segment> &segments)
+{
+    qreal maxDist = 0;
+    int i = 0;
+    for (int s = 1; s < segments.count(); ++s) {
+        const SimplifyQt::Segment &prev = segments.at(s - 1);
+        const SimplifyQt::Segment &next = segments.at(s);
+        QPointF curves[4] = {
+            prev.endPoint(),
+            prev.endPoint() + prev.control2(),
+            next.endPoint() + next.control1(),
+            next.endPoint()
+        };
+        for (; (i < points.count()) && (points.at(i).x() <= next.endPointX()); ++i) {
+            qreal dist = std::numeric_limits<qreal>::max();
+            for (int k = 0; k <= 1024; ++k) {
+                QPointF v = deCasteljau(curves, 3, k / 1024.0) - points.at(i);
+                dist = qMin(dist, SimplifyQt::PathFitterSw::dot(v, v));
+            }
+            maxDist = qMax(maxDist, dist);
+        }
+    }
+
+    return std::sqrt(maxDist);
+}
+
+// Same segments bit for bit.
+static bool sameSegments(const QVector<SimplifyQt::Segment> &a, const QVector<SimplifyQt::Segment> &b)
+{
+    return (a.count() == b.count()) && (memcmp(a.constData(), b.constData(), a.count() * sizeof(SimplifyQt::Segment)) == 0);
+}
+
+// Spikes on every second point that grow towards the end: every split of
+// the plain fit lands next to the right endpoint, so the spans nest about
+// as deep as there are points.
+static QVector<QPointF> risingSpikes()
+{
+    QVector<QPointF> spikes;
+    for (int i = 0; i < 20000; ++i) {
+        spikes.append(QPointF(i, (i % 2) ? 0.0 : 1000.0 * std::pow(1.001, i)));
+    }
+
+    return spikes;
+}
+
+// Zoom levels of a map, coarse to fine.
+static const QVector<qreal> levelTolerances = { 80, 40, 20, 10, 5, 2.5, 1, 0.5 };
+
+// class SimplifyTest
+
+void SimplifyTest::initTestCase()
+{
+    int yoffset = 0;
+    for (int i = 0; i < 10000; ++i) {
+        int r = qrand() % 50 - 25;
+        int y = r + 100 + yoffset;
+        yoffset += r;
+        points.append(QPointF(i * 3, y));
+    }
+
+    // A pen stroke sampled much finer than the tolerance.
+    for (int i = 0; i < 20000; ++i) {
+        qreal jitter = (qrand() % 3 - 1) * 0.05;
+        stroke.append(QPointF(i * 0.05, 40 * std::sin(i * 0.002) + jitter));
+    }
+}
+
+void SimplifyTest::cleanupTestCase()
+{
+}
+
+void SimplifyTest::simplifySw()
+{
+    QBENCHMARK {
+        segmentsSw = SimplifyQt::simplifySw(points);
+    }
+}
+
+void SimplifyTest::simplifyIs()
+{
+    QBENCHMARK {
+        segmentsIs = SimplifyQt::simplifyIs(points);
+    }
+}
+
+void SimplifyTest::compareSegments()
+{
+    // The SSE2 kernels round exactly like the software fitter, the FMA ones do not.
+    const SimplifyQt::PathKernels *kernels = SimplifyQt::pathKernels(SimplifyQt::SimdSse2);
+    if (!kernels)
+        kernels = SimplifyQt::pathKernels(SimplifyQt::SimdNone);
+    QVector<SimplifyQt::Segment> segmentsExact = SimplifyQt::PathFitterIs(points, *kernels).fit(2.5);
+
+    QVERIFY(segmentsSw.count() == segmentsExact.count());
+
+    int c = segmentsSw.count();
+    for (int i = 0; i < c; ++i) {
+        QVERIFY(segmentsSw[i] == segmentsExact[i]);
+    }
+
+    // The dispatched kernels may fuse multiply-adds and split elsewhere,
+    // but keep the ends and the tolerance.
+    QVERIFY(!segmentsIs.isEmpty());
+    QVERIFY(segmentsIs.first().endPoint() == points.first());
+    QVERIFY(segmentsIs.last().endPoint() == points.last());
+    QVERIFY(maxDeviation(points, segmentsIs) < std::sqrt(2.5) + 0.05);
+}
+
+void SimplifyTest::compareKernels()
+{
+    const SimplifyQt::PathKernels *generic = SimplifyQt::pathKernels(SimplifyQt::SimdNone);
+    QVERIFY(generic);
+
+    SimplifyQt::PathPoints soa(points);
+
+    for (int level = SimplifyQt::SimdSse2; level <= SimplifyQt::SimdAvx512; ++level) {
+        const SimplifyQt::PathKernels *kernels = SimplifyQt::pathKernels(SimplifyQt::SimdLevel(level));
+        if (!kernels)
+            continue;
+
+        // Loading and parameterizing are exact at every level.
+        SimplifyQt::PathPoints loaded(points, *kernels);
+        QVERIFY2(memcmp(loaded.x(), soa.x(), points.count() * sizeof(qreal)) == 0, kernels->name);
+        QVERIFY2(memcmp(loaded.y(), soa.y(), points.count() * sizeof(qreal)) == 0, kernels->name);
+        QVERIFY2(memcmp(loaded.lengths(), soa.lengths(), points.count() * sizeof(qreal)) == 0, kernels->name);
+
+        for (int count = 2; count < 40; ++count) {
+            QVector<qreal> expected(count);
+            QVector<qreal> actual(count);
+            generic->chordLengthParameterize(soa.lengths() + count, count, expected.data());
+            kernels->chordLengthParameterize(soa.lengths() + count, count, actual.data());
+            QVERIFY2(memcmp(expected.constData(), actual.constData(), count * sizeof(qreal)) == 0, kernels->name);
+        }
+
+        for (int count = 3; count < 40; ++count) {
+            int first = count * 7;
+            int last = first + count - 1;
+
+            QPointF curves[4] = {
+                points[first],
+                points[first] + QPointF(30, 40),
+                points[last] + QPointF(-30, 10),
+                points[last]
+            };
+            QVector<qreal> u(count);
+            SimplifyQt::PathFitterSw(points).chordLengthParameterize(first, last, u.data());
+
+            const qreal *x = soa.x() + first;
+            const qreal *y = soa.y() + first;
+            QPair<qreal, int> expected = generic->findMaxError(x, y, u.constData(), count, curves);
+            QPair<qreal, int> actual = kernels->findMaxError(x, y, u.constData(), count, curves);
+            QVERIFY2(qFuzzyCompare(expected.first, actual.first), kernels->name);
+            QVERIFY2(expected.second == actual.second, kernels->name);
+        }
+    }
+}
+
+void SimplifyTest::deepSplits()
+{
+    const QVector<QPointF> spikes = risingSpikes();
+
+    for (bool software : { true, false }) {
+        FitThread thread(spikes, software);
+        thread.setStackSize(64 * 1024);
+        thread.start();
+        QVERIFY(thread.wait());
+
+        const QVector<SimplifyQt::Segment> &segments = thread.segments;
+        QVERIFY(segments.count() > 1);
+        QVERIFY(segments.first().endPoint() == spikes.first());
+        QVERIFY(segments.last().endPoint() == spikes.last());
+        for (int i = 1; i < segments.count(); ++i) {
+            QVERIFY(segments[i].endPointX() > segments[i - 1].endPointX());
+        }
+    }
+}
+
+void SimplifyTest::compareParallel()
+{
+    const QVector<QPointF> spikes = risingSpikes();
+
+    for (const QVector<QPointF> &input : { points, spikes }) {
+        QVector<SimplifyQt::Segment> expected = SimplifyQt::simplifySw(input);
+
+        // A tiny grain size hands almost every split to another task.
+        for (int grainSize : { 16, 256 }) {
+            SimplifyQt::PathFitterSw fitter(input);
+            QVector<SimplifyQt::Segment> actual = SimplifyQt::ParallelFit<SimplifyQt::PathFitterSw>(fitter, 4, grainSize).fit(2.5);
+
+            QVERIFY(sameSegments(actual, expected));
+        }
+
+        QVector<SimplifyQt::Segment> segmentsIs = SimplifyQt::simplifyIs(input);
+        QVector<SimplifyQt::Segment> parallelIs = SimplifyQt::simplifyIsParallel(input);
+        QVERIFY(sameSegments(parallelIs, segmentsIs));
+    }
+}
+
+void SimplifyTest::streaming()
+{
+    const qreal tolerance = 2.5;
+    QVector<SimplifyQt::Segment> batch = SimplifyQt::simplifyIs(points, tolerance);
+    qreal batchDeviation = maxDeviation(points, batch);
+
+    SimplifyQt::StreamingSimplifier simplifier(tolerance, 32);
+    QVector<SimplifyQt::Segment> committed;
+    for (const QPointF &point : points) {
+        simplifier.addPoint(point);
+        QVERIFY(simplifier.pendingCount() <= 4 * simplifier.window() + 1);
+
+        // Committed segments never move, only the open handle of the last one.
+        const QVector<SimplifyQt::Segment> &segments = simplifier.segments();
+        QVERIFY(simplifier.committedCount() >= committed.count());
+        for (int i = 0; i < committed.count(); ++i) {
+            QVERIFY(segments.at(i).endPoint() == committed.at(i).endPoint());
+            QVERIFY(segments.at(i).control1() == committed.at(i).control1());
+            if (i < committed.count() - 1)
+                QVERIFY(segments.at(i).control2() == committed.at(i).control2());
+        }
+        committed = segments.mid(0, simplifier.committedCount());
+    }
+    QVERIFY(simplifier.committedCount() > 1);
+
+    QVector<SimplifyQt::Segment> streamed = simplifier.finish();
+    QVERIFY(simplifier.segments().isEmpty());
+    QVERIFY(streamed.first().endPoint() == points.first());
+    QVERIFY(streamed.last().endPoint() == points.last());
+    QVERIFY(maxDeviation(points, streamed) <= batchDeviation + 0.01);
+
+    simplifier.addPoints(points);
+    QVector<SimplifyQt::Segment> chunked = simplifier.finish();
+    QVERIFY(chunked.last().endPoint() == points.last());
+    QVERIFY(maxDeviation(points, chunked) <= batchDeviation + 0.01);
+
+    // A straight stroke is one curve, the tail is split to stay short.
+    QVector<QPointF> line;
+    for (int i = 0; i < 1000; ++i) {
+        line.append(QPointF(i, i * 0.5));
+    }
+    for (const QPointF &point : line) {
+        simplifier.addPoint(point);
+        QVERIFY(simplifier.pendingCount() <= 4 * simplifier.window() + 1);
+    }
+    QVERIFY(simplifier.finish().last().endPoint() == line.last());
+
+    // Degenerate strokes.
+    QVERIFY(simplifier.finish().isEmpty());
+    simplifier.addPoint(QPointF(1, 2));
+    QVector<SimplifyQt::Segment> single = simplifier.finish();
+    QVERIFY(single.count() == 1);
+    QVERIFY(single.first().endPoint() == QPointF(1, 2));
+
+    if (!AllocationCounter::isAvailable())
+        QSKIP("Heap allocations cannot be counted here");
+
+    // Refits reuse one fitter: once a stroke has grown the segments, the
+    // next one of the same length does not touch the heap.
+    for (const QPointF &point : points)
+        simplifier.addPoint(point);
+    simplifier.reset();
+    AllocationCounter::reset();
+    for (const QPointF &point : points)
+        simplifier.addPoint(point);
+    QVERIFY(AllocationCounter::allocations() == 0);
+}
+
+void SimplifyTest::batch()
+{
+    // Strokes of 0 to 96 points cut from the random walk.
+    QVector<QVector<QPointF> > polylines;
+    QVector<QPointF> flat;
+    QVector<int> offsets;
+    offsets.append(0);
+    for (int i = 0, n = 0; i < points.count(); i += n, ++n) {
+        n = qMin(n % 97, points.count() - i);
+        polylines.append(points.mid(i, n));
+        flat += polylines.last();
+        offsets.append(flat.count());
+    }
+
+    for (int threadCount : { 1, 4 }) {
+        SimplifyQt::SegmentBatch batchIs = SimplifyQt::simplifyIsBatch(polylines, 2.5, threadCount);
+        SimplifyQt::SegmentBatch batchSw = SimplifyQt::simplifySwBatch(flat, offsets, 2.5, threadCount);
+        // The dispatched kernels may split elsewhere than the software
+        // fitter, each batch is checked against its own fitter.
+        for (const SimplifyQt::SegmentBatch *batch : { &batchIs, &batchSw }) {
+            QVERIFY(batch->offsets.count() == polylines.count() + 1);
+            QVERIFY(batch->offsets.first() == 0);
+            QVERIFY(batch->segments.count() == batch->offsets.last());
+        }
+
+        for (int i = 0; i < polylines.count(); ++i) {
+            QVector<SimplifyQt::Segment> expectedIs = SimplifyQt::simplifyIs(polylines.at(i));
+            QVector<SimplifyQt::Segment> expectedSw = SimplifyQt::simplifySw(polylines.at(i));
+            const int countIs = batchIs.offsets.at(i + 1) - batchIs.offsets.at(i);
+            const int countSw = batchSw.offsets.at(i + 1) - batchSw.offsets.at(i);
+            QVERIFY(sameSegments(batchIs.segments.mid(batchIs.offsets.at(i), countIs), expectedIs));
+            QVERIFY(sameSegments(batchSw.segments.mid(batchSw.offsets.at(i), countSw), expectedSw));
+        }
+    }
+
+    QVERIFY(SimplifyQt::simplifyIsBatch(QVector<QVector<QPointF> >()).segments.isEmpty());
+
+    // Malformed offsets give an empty batch.
+    const QVector<int> badOffsets[] = {
+        QVector<int>(),
+        QVector<int>() << 1 << flat.count(),
+        QVector<int>() << 0 << 10 << 5 << flat.count(),
+        QVector<int>() << 0 << flat.count() + 1
+    };
+    for (const QVector<int> &bad : badOffsets) {
+        SimplifyQt::SegmentBatch batch = SimplifyQt::simplifySwBatch(flat, bad);
+        QVERIFY(batch.segments.isEmpty() && batch.offsets.isEmpty());
+        QVERIFY(SimplifyQt::simplifyIsBatch(flat, bad).offsets.isEmpty());
+    }
+}
+
+void SimplifyTest::pointSpans()
+{
+    // The walk has integer coordinates, so the float copies are exact.
+    int c = points.count();
+    QVector<qreal> x(c);
+    QVector<qreal> y(c);
+    QVector<float> xy(2 * c);
+    for (int i = 0; i < c; ++i) {
+        x[i] = points.at(i).x();
+        y[i] = points.at(i).y();
+        xy[2 * i] = points.at(i).x();
+        xy[2 * i + 1] = points.at(i).y();
+    }
+    const qreal *interleaved = reinterpret_cast<const qreal *>(points.constData());
+
+    const SimplifyQt::PointSpan spans[] = {
+        SimplifyQt::PointSpan(points.constData(), c),
+        SimplifyQt::PointSpan(x.constData(), y.constData(), c),
+        SimplifyQt::PointSpan(interleaved, interleaved + 1, c / 2, 4),
+        SimplifyQt::PointSpan(xy.constData(), xy.constData() + 1, c, 2)
+    };
+
+    for (const SimplifyQt::PointSpan &span : spans) {
+        QVector<QPointF> copy;
+        for (int i = 0; i < span.count(); ++i) {
+            copy.append(span.at(i));
+        }
+
+        QVector<SimplifyQt::Segment> expectedIs = SimplifyQt::simplifyIs(copy);
+        QVector<SimplifyQt::Segment> actualIs = SimplifyQt::simplifyIs(span);
+        QVERIFY(sameSegments(actualIs, expectedIs));
+
+        QVector<SimplifyQt::Segment> expectedSw = SimplifyQt::simplifySw(copy);
+        QVector<SimplifyQt::Segment> actualSw = SimplifyQt::simplifySw(span);
+        QVERIFY(sameSegments(actualSw, expectedSw));
+    }
+
+    QVERIFY(SimplifyQt::simplifyIs(SimplifyQt::PointSpan(x.constData(), y.constData(), 0)).isEmpty());
+}
+
+void SimplifyTest::curveSinks()
+{
+    // Segments keep the handles relative to their end point; the same
+    // subtraction on the absolute output gives them back bit for bit.
+    for (bool software : { true, false }) {
+        QVector<SimplifyQt::Segment> segments = software ? SimplifyQt::simplifySw(points) : SimplifyQt::simplifyIs(points);
+        QVector<qreal> cubics;
+        QVector<float> cubicsF;
+        if (software) {
+            SimplifyQt::simplifySw(points, cubics);
+            SimplifyQt::simplifySw(points, cubicsF);
+        } else {
+            SimplifyQt::simplifyIs(points, cubics);
+            SimplifyQt::simplifyIs(points, cubicsF);
+        }
+
+        QVERIFY(cubics.count() == 2 + 6 * (segments.count() - 1));
+        QVERIFY(cubicsF.count() == cubics.count());
+        QVERIFY(QPointF(cubics[0], cubics[1]) == segments.first().endPoint());
+        for (int i = 1; i < segments.count(); ++i) {
+            const qreal *curve = cubics.constData() + 6 * i - 6;
+            QPointF start(curve[0], curve[1]);
+            QPointF end(curve[6], curve[7]);
+            QPointF handleOut = QPointF(curve[2], curve[3]) - start;
+            QPointF handleIn = QPointF(curve[4], curve[5]) - end;
+            QVERIFY(end == segments.at(i).endPoint());
+            QVERIFY(memcmp(&segments.at(i - 1).control2(), &handleOut, sizeof(QPointF)) == 0);
+            QVERIFY(memcmp(&segments.at(i).control1(), &handleIn, sizeof(QPointF)) == 0);
+        }
+        for (int i = 0; i < cubics.count(); ++i) {
+            QVERIFY(cubicsF.at(i) == float(cubics.at(i)));
+        }
+    }
+
+    // Output is appended.
+    QVector<qreal> cubics(3, 1.0);
+    SimplifyQt::simplifyIs(points.mid(0, 2), cubics);
+    QVERIFY(cubics.count() == 3 + 2 + 6);
+    QVERIFY(cubics.at(2) == 1.0);
+}
+
+void SimplifyTest::compareFloat()
+{
+#if defined(QT_COORD_TYPE)
+    QSKIP("qreal is float, there are no separate float kernels");
+#else
+    const SimplifyQt::PathKernelsF *generic = SimplifyQt::pathKernelsF(SimplifyQt::SimdNone);
+    QVERIFY(generic);
+
+    SimplifyQt::PathPointsF soa(points);
+    QVERIFY(soa.origin() == points.first());
+    QVERIFY(soa.at(0) == QPointF());
+
+    for (int level = SimplifyQt::SimdSse2; level <= SimplifyQt::SimdAvx512; ++level) {
+        const SimplifyQt::PathKernelsF *kernels = SimplifyQt::pathKernelsF(SimplifyQt::SimdLevel(level));
+        if (!kernels)
+            continue;
+
+        // Loading and parameterizing are exact at every level.
+        SimplifyQt::PathPointsF loaded(points, *kernels);
+        QVERIFY2(memcmp(loaded.x(), soa.x(), points.count() * sizeof(float)) == 0, kernels->name);
+        QVERIFY2(memcmp(loaded.y(), soa.y(), points.count() * sizeof(float)) == 0, kernels->name);
+        QVERIFY2(memcmp(loaded.lengths(), soa.lengths(), points.count() * sizeof(qreal)) == 0, kernels->name);
+
+        for (int count = 2; count < 40; ++count) {
+            QVector<float> expected(count);
+            QVector<float> actual(count);
+            generic->chordLengthParameterize(soa.lengths() + count, count, expected.data());
+            kernels->chordLengthParameterize(soa.lengths() + count, count, actual.data());
+            QVERIFY2(memcmp(expected.constData(), actual.constData(), count * sizeof(float)) == 0, kernels->name);
+        }
+
+        // The FMA levels round differently, the maximum only has to agree
+        // to float precision.
+        for (int count = 3; count < 80; ++count) {
+            int first = count * 7;
+            int last = first + count - 1;
+
+            QPointF curves[4] = {
+                soa.at(first),
+                soa.at(first) + QPointF(30, 40),
+                soa.at(last) + QPointF(-30, 10),
+                soa.at(last)
+            };
+            QVector<float> u(count);
+            generic->chordLengthParameterize(soa.lengths() + first, count, u.data());
+
+            const float *x = soa.x() + first;
+            const float *y = soa.y() + first;
+            QPair<qreal, int> expected = generic->findMaxError(x, y, u.constData(), count, curves);
+            QPair<qreal, int> actual = kernels->findMaxError(x, y, u.constData(), count, curves);
+            QVERIFY2(qAbs(expected.first - actual.first) <= 1e-4 * expected.first, kernels->name);
+        }
+    }
+
+    // Far from the origin a float has no fraction left; the recentred fit
+    // stays as close to the points as the qreal one.
+    QVector<QPointF> shifted;
+    for (const QPointF &point : points) {
+        shifted.append(point + QPointF(1e7, -1e7));
+    }
+
+    const qreal tolerance = 2.5;
+    qreal deviation = maxDeviation(shifted, SimplifyQt::simplifyIs(shifted, tolerance));
+    QVector<SimplifyQt::Segment> segments = SimplifyQt::simplifyIsFloat(shifted, tolerance);
+    QVERIFY(segments.first().endPoint() == shifted.first());
+    QVERIFY(segments.last().endPoint() == shifted.last());
+    QVERIFY(maxDeviation(shifted, segments) <= deviation + 0.01);
+
+    QVERIFY(SimplifyQt::simplifyIsFloat(QVector<QPointF>()).isEmpty());
+#endif
+}
+
+void SimplifyTest::decimation()
+{
+    // Dropped points count against the tolerance like kept ones: sqrt(2.5)
+    // is the distance the fitter guarantees, plus the sampling slack of
+    // maxDeviation().
+    const qreal tolerance = 2.5;
+    const qreal bound = std::sqrt(tolerance) + 0.05;
+
+    for (qreal fraction : { 0.0, 0.25, 0.5, 0.9 }) {
+        SimplifyQt::Decimation decimation(stroke, tolerance, fraction);
+        QVERIFY(decimation.points.first() == stroke.first());
+        QVERIFY(decimation.points.last() == stroke.last());
+        QVERIFY(decimation.tolerance <= tolerance);
+
+        QVector<SimplifyQt::Segment> segmentsIs = SimplifyQt::simplifyIsDecimated(stroke, tolerance, fraction);
+        QVector<SimplifyQt::Segment> segmentsSw = SimplifyQt::simplifySwDecimated(stroke, tolerance, fraction);
+        QVERIFY(segmentsIs.first().endPoint() == stroke.first());
+        QVERIFY(segmentsIs.last().endPoint() == stroke.last());
+        QVERIFY(maxDeviation(stroke, segmentsIs) <= bound);
+        QVERIFY(maxDeviation(stroke, segmentsSw) <= bound);
+    }
+
+    // Nothing is dropped without a radius, or from input coarser than it.
+    QVERIFY(SimplifyQt::Decimation(stroke, 2.5, 0.0).points.count() == stroke.count());
+    QVERIFY(SimplifyQt::Decimation(points, 2.5, 0.25).points.count() == points.count());
+
+    // The stroke is twenty times denser than a quarter of the tolerance.
+    QVERIFY(SimplifyQt::Decimation(stroke, 2.5, 0.25).points.count() < stroke.count() / 4);
+
+    QVERIFY(SimplifyQt::simplifyIsDecimated(QVector<QPointF>()).isEmpty());
+    QVERIFY(SimplifyQt::simplifyIsDecimated(stroke.mid(0, 1)).count() == 1);
+}
+
+void SimplifyTest::levels()
+{
+    // Any order, repeats included, and more levels than one walk takes.
+    QVector<qreal> tolerances = levelTolerances;
+    tolerances << 2.5 << 0.1 << 300 << 7;
+    for (int i = 0; i < 60; ++i) {
+        tolerances << 0.25 * (i + 1);
+    }
+
+    for (bool software : { true, false }) {
+        for (const QVector<QPointF> *input : { &points, &stroke }) {
+            QVector<QVector<SimplifyQt::Segment> > levels = software
+                    ? SimplifyQt::simplifySwLevels(*input, tolerances)
+                    : SimplifyQt::simplifyIsLevels(*input, tolerances);
+            QVERIFY(levels.count() == tolerances.count());
+
+            for (int l = 0; l < tolerances.count(); ++l) {
+                QVector<SimplifyQt::Segment> expected = software
+                        ? SimplifyQt::simplifySw(*input, tolerances.at(l))
+                        : SimplifyQt::simplifyIs(*input, tolerances.at(l));
+                QVERIFY(sameSegments(levels.at(l), expected));
+            }
+        }
+    }
+
+    QVERIFY(SimplifyQt::simplifyIsLevels(points, QVector<qreal>()).isEmpty());
+    QVERIFY(SimplifyQt::simplifyIsLevels(QVector<QPointF>(), levelTolerances).at(3).isEmpty());
+    QVERIFY(SimplifyQt::simplifyIsLevels(points.mid(0, 1), levelTolerances).at(3).count() == 1);
+}
+
+void SimplifyTest::fitCache()
+{
+    SimplifyQt::FitCache cache(1 << 24);
+    QVector<SimplifyQt::Segment> expected = SimplifyQt::simplifyIs(points);
+
+    QVector<SimplifyQt::Segment> missed = cache.simplifyIs(points);
+    QVector<SimplifyQt::Segment> hit = cache.simplifyIs(points);
+    QVERIFY((cache.misses() == 1) && (cache.hits() == 1) && (cache.count() == 1));
+    QVERIFY(sameSegments(missed, expected));
+    QVERIFY(sameSegments(hit, expected));
+
+    // The key is the point values, not the layout they come in.
+    QVector<qreal> x;
+    QVector<qreal> y;
+    for (const QPointF &point : points) {
+        x.append(point.x());
+        y.append(point.y());
+    }
+    cache.simplifyIs(SimplifyQt::PointSpan(x.constData(), y.constData(), x.count()));
+    QVERIFY(cache.hits() == 2);
+
+    // Another fitter, tolerance or point is another key.
+    QVector<QPointF> moved = points;
+    moved[points.count() / 2] += QPointF(0, 0.5);
+    QVERIFY(sameSegments(cache.simplifySw(points), SimplifyQt::simplifySw(points)));
+    cache.simplifyIs(points, 5.0);
+    cache.simplifyIs(moved);
+    QVERIFY((cache.misses() == 4) && (cache.hits() == 2) && (cache.count() == 4));
+
+    cache.clear();
+    QVERIFY((cache.count() == 0) && (cache.bytes() == 0) && (cache.misses() == 4));
+
+    // Least recently used goes first.
+    QVector<QPointF> a = points.mid(0, 1000);
+    QVector<QPointF> b = points.mid(1000, 1000);
+    QVector<QPointF> c = points.mid(2000, 1000);
+    SimplifyQt::FitCache probe;
+    probe.simplifyIs(c);
+    cache.simplifyIs(a);
+    qint64 bytesA = cache.bytes();
+    cache.simplifyIs(b);
+    cache.setMaxBytes(bytesA + qMax(cache.bytes() - bytesA, probe.bytes()));
+    cache.simplifyIs(a);
+    cache.simplifyIs(c);
+    QVERIFY((cache.evictions() == 1) && (cache.count() == 2));
+    QVERIFY(cache.bytes() <= cache.maxBytes());
+    quint64 misses = cache.misses();
+    cache.simplifyIs(a);
+    QVERIFY(cache.misses() == misses);
+    cache.simplifyIs(b);
+    QVERIFY(cache.misses() == misses + 1);
+
+    // A result over the cap is returned, not kept.
+    cache.setMaxBytes(16);
+    QVERIFY(cache.count() == 0);
+    QVERIFY(sameSegments(cache.simplifyIs(points), expected));
+    QVERIFY(cache.count() == 0);
+
+    // Threads sharing one cache.
+    SimplifyQt::FitCache shared;
+    QVector<QVector<QPointF> > polylines = { a, b, c, points };
+    QVector<CacheThread *> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.append(new CacheThread(&shared, &polylines));
+        threads.last()->start();
+    }
+    for (CacheThread *thread : threads) {
+        thread->wait();
+        for (int i = 0; i < thread->segments.count(); ++i) {
+            QVERIFY(sameSegments(thread->segments.at(i), SimplifyQt::simplifyIs(polylines.at(i % polylines.count()))));
+        }
+        delete thread;
+    }
+    QVERIFY(shared.hits() + shared.misses() == 8 * 100 * 4);
+    QVERIFY(shared.count() == 4);
+}
+
+void SimplifyTest::fitStats()
+{
+    for (bool software : { true, false }) {
+        for (const QVector<QPointF> *input : { &points, &stroke }) {
+            SimplifyQt::FitStats stats;
+            QVector<SimplifyQt::Segment> segments = software
+                    ? SimplifyQt::simplifySw(*input, stats)
+                    : SimplifyQt::simplifyIs(*input, stats);
+            QVERIFY(sameSegments(segments, software ? SimplifyQt::simplifySw(*input) : SimplifyQt::simplifyIs(*input)));
+
+            // Every span either adds a curve or splits in two.
+            int splits = stats.splits.count();
+            QVERIFY(stats.spans == 2 * splits + 1);
+            QVERIFY(stats.spans - splits == segments.count() - 1);
+            QVERIFY(stats.maxDepth > 0 && stats.maxDepth <= splits);
+            for (int split : stats.splits) {
+                QVERIFY(split > 0 && split < input->count() - 1);
+            }
+
+            // Line spans take no rounds, the others one to MaxFitRounds.
+            int fitted = 0;
+            int iterations = 0;
+            QVERIFY(stats.iterationHistogram.count() <= SimplifyQt::MaxFitRounds);
+            for (int i = 0; i < stats.iterationHistogram.count(); ++i) {
+                fitted += stats.iterationHistogram.at(i);
+                iterations += (i + 1) * stats.iterationHistogram.at(i);
+            }
+            QVERIFY(fitted == stats.spans - stats.lineSpans);
+            QVERIFY(iterations == stats.iterations);
+            QVERIFY(stats.earlyBreaks <= fitted);
+            QVERIFY(stats.reparameterizeCalls <= stats.iterations - fitted);
+            QVERIFY(stats.findRootCalls >= stats.reparameterizeCalls);
+
+            QVERIFY(stats.generateBezierTime > 0 && stats.findMaxErrorTime > 0);
+            QVERIFY(stats.parameterizeTime >= 0 && stats.reparameterizeTime >= 0);
+        }
+    }
+
+    // Counts add up over calls, nothing is fitted without two points.
+    SimplifyQt::FitStats stats;
+    SimplifyQt::simplifyIs(points.mid(0, 1), stats);
+    QVERIFY(stats.spans == 0 && stats.iterationHistogram.isEmpty());
+    SimplifyQt::simplifyIs(points.mid(0, 2), stats);
+    SimplifyQt::simplifyIs(points.mid(0, 2), stats);
+    QVERIFY(stats.spans == 2 && stats.lineSpans == 2 && stats.iterations == 0);
+}
+
+void SimplifyTest::reparameterize()
+{
+    // Points on a known curve, bunched up towards its start: chord lengths
+    // are poor parameters for them, Newton steps have to find the real ones.
+    const QPointF curve[4] = { QPointF(0, 0), QPointF(10, 20), QPointF(30, 20), QPointF(40, 0) };
+    QVector<QPointF> samples;
+    for (int i = 0; i <= 20; ++i) {
+        qreal t = (i / 20.0) * (i / 20.0);
+        samples.append(deCasteljau(curve, 3, t));
+    }
+
+    QPointF point = deCasteljau(curve, 3, 0.3);
+    QVERIFY(std::abs(SimplifyQt::PathFitterSw(samples).findRoot(curve, point, 0.35) - 0.3) < 0.01);
+    QVERIFY(std::abs(SimplifyQt::PathFitterIs(samples).findRoot(curve, point, 0.35) - 0.3) < 0.01);
+
+    SimplifyQt::PathFitterSw fitterSw(samples);
+    SimplifyQt::PathFitterIs fitterIs(samples);
+    QVector<qreal> uSw(samples.count());
+    QVector<qreal> uIs(samples.count());
+    fitterSw.chordLengthParameterize(0, 20, uSw.data());
+    fitterIs.chordLengthParameterize(0, 20, uIs.data());
+    qreal before = fitterSw.findMaxError(0, 20, curve, uSw.constData()).first;
+    for (int i = 0; i < 4; ++i) {
+        QVERIFY(fitterSw.reparameterize(0, 20, uSw.data(), curve));
+        QVERIFY(fitterIs.reparameterize(0, 20, uIs.data(), curve));
+    }
+    QVERIFY(fitterSw.findMaxError(0, 20, curve, uSw.constData()).first < before * 1e-6);
+    QVERIFY(fitterIs.findMaxError(0, 20, curve, uIs.constData()).first < before * 1e-6);
+}
+
+void SimplifyTest::powerBasis()
+{
+    // Same points as PathFitter.js finds by de Casteljau, to rounding.
+    const QPointF curve[4] = { QPointF(512.25, -80), QPointF(530, 12.5), QPointF(601.75, 40), QPointF(640, -3) };
+    SimplifyQt::PowerBasis<1> basis1 = SimplifyQt::powerBasis<1>(curve);
+    SimplifyQt::PowerBasis<2> basis2 = SimplifyQt::powerBasis<2>(curve);
+    SimplifyQt::PowerBasis<3> basis3 = SimplifyQt::powerBasis<3>(curve);
+    SimplifyQt::PowerBasis<3, float> basis3F = SimplifyQt::powerBasis<3, float>(curve);
+
+    // Derivatives are the curves of the scaled control point differences.
+    QPointF curve1[3];
+    QPointF curve2[2];
+    for (int i = 0; i < 3; ++i) {
+        curve1[i] = (curve[i + 1] - curve[i]) * 3;
+    }
+    for (int i = 0; i < 2; ++i) {
+        curve2[i] = (curve1[i + 1] - curve1[i]) * 2;
+    }
+    SimplifyQt::PowerBasis<2> derivative1 = SimplifyQt::derivative(basis3);
+    SimplifyQt::PowerBasis<1> derivative2 = SimplifyQt::derivative(derivative1);
+
+    for (int i = 0; i <= 64; ++i) {
+        qreal t = i / 64.0;
+        QPointF expected3 = deCasteljau(curve, 3, t);
+        QVERIFY((SimplifyQt::evaluate(basis1, t) - deCasteljau(curve, 1, t)).manhattanLength() < 1e-9);
+        QVERIFY((SimplifyQt::evaluate(basis2, t) - deCasteljau(curve, 2, t)).manhattanLength() < 1e-9);
+        QVERIFY((SimplifyQt::evaluate(basis3, t) - expected3).manhattanLength() < 1e-9);
+        QVERIFY((SimplifyQt::evaluate(derivative1, t) - deCasteljau(curve1, 2, t)).manhattanLength() < 1e-9);
+        QVERIFY((SimplifyQt::evaluate(derivative2, t) - deCasteljau(curve2, 1, t)).manhattanLength() < 1e-9);
+
+        float x = SimplifyQt::evaluate<3>(basis3F.x, float(t));
+        float y = SimplifyQt::evaluate<3>(basis3F.y, float(t));
+        QVERIFY((QPointF(x, y) - expected3).manhattanLength() < 1e-3);
+    }
+
+    // The ends are the end points exactly.
+    QVERIFY(SimplifyQt::evaluate(basis3, 0.0) == curve[0]);
+    QVERIFY(SimplifyQt::evaluate(basis1, 1.0) == curve[1]);
+}
+
+void SimplifyTest::corners()
+{
+    // A saw tooth turns by 90 degrees every 100 points.
+    QVector<QPointF> saw;
+    for (int i = 0; i <= 1000; ++i) {
+        saw.append(QPointF(i, std::abs((i % 200) - 100)));
+    }
+
+    SimplifyQt::PathPoints path(saw);
+    const qreal radius = SimplifyQt::Corners::radius(2.5);
+    QVector<int> expected;
+    for (int i = 0; i <= 1000; i += 100) {
+        expected.append(i);
+    }
+    QVERIFY(SimplifyQt::Corners(path, radius, 60).indices == expected);
+    QVERIFY(SimplifyQt::Corners(path, radius, 120).indices == (QVector<int>() << 0 << 1000));
+
+    // Every corner is a segment end.
+    QVector<SimplifyQt::Segment> sharp = SimplifyQt::simplifyIsCorners(saw);
+    for (int i = 100; i < 1000; i += 100) {
+        bool found = false;
+        for (const SimplifyQt::Segment &segment : sharp) {
+            found = found || (segment.endPoint() == saw.at(i));
+        }
+        QVERIFY(found);
+    }
+    QVERIFY(maxDeviation(saw, sharp) < std::sqrt(2.5) + 0.05);
+
+    // Without corners the spans are those of fit(), and so are the segments.
+    SimplifyQt::PathFitterSw fitter(points);
+    QVector<int> ends = QVector<int>() << 0 << (points.count() - 1);
+    QVERIFY(sameSegments(SimplifyQt::ParallelFit<SimplifyQt::PathFitterSw>(fitter, 1).fit(2.5, ends), fitter.fit(2.5)));
+    QVERIFY(sameSegments(SimplifyQt::ParallelFit<SimplifyQt::PathFitterSw>(fitter, 4, 16).fit(2.5, ends), fitter.fit(2.5)));
+
+    // The segments do not depend on how the spans are spread over threads.
+    SimplifyQt::Corners found(fitter.path(), radius, 60);
+    QVERIFY(found.indices.count() > 2);
+    QVector<SimplifyQt::Segment> sequential = SimplifyQt::ParallelFit<SimplifyQt::PathFitterSw>(fitter, 1).fit(2.5, found.indices);
+    QVERIFY(sameSegments(SimplifyQt::ParallelFit<SimplifyQt::PathFitterSw>(fitter, 4, 16).fit(2.5, found.indices), sequential));
+    QVERIFY(sameSegments(SimplifyQt::simplifySwCorners(points, 2.5, 60, 1), sequential));
+    QVERIFY(sameSegments(SimplifyQt::simplifyIsCorners(points, 2.5, 60, 1), SimplifyQt::simplifyIsCorners(points, 2.5, 60, 4)));
+    QVERIFY(maxDeviation(points, sequential) < std::sqrt(2.5) + 0.05);
+
+    QVERIFY(SimplifyQt::simplifyIsCorners(QVector<QPointF>()).isEmpty());
+    QVERIFY(SimplifyQt::simplifyIsCorners(points.mid(0, 1)).count() == 1);
+    QVERIFY(SimplifyQt::simplifyIsCorners(points.mid(0, 2)).count() == 2);
+}
+
+void SimplifyTest::windowed()
+{
+    // A window that holds every point is one plain fit, and the sink gets
+    // the very control points the fitter computed.
+    SegmentSink whole;
+    SegmentSink plain;
+    SimplifyQt::simplifyIsWindowed(points, whole, 2.5, points.count());
+    SimplifyQt::simplifyIs(points, plain);
+    QVERIFY(sameSegments(whole.segments, plain.segments));
+
+    for (int window : { 16, 100, 1000 }) {
+        SegmentSink sinkIs;
+        SegmentSink sinkSw;
+        SimplifyQt::simplifyIsWindowed(points, sinkIs, 2.5, window);
+        SimplifyQt::simplifySwWindowed(points, sinkSw, 2.5, window);
+
+        for (const QVector<SimplifyQt::Segment> &segments : { sinkIs.segments, sinkSw.segments }) {
+            QVERIFY(segments.first().endPoint() == points.first());
+            QVERIFY(segments.last().endPoint() == points.last());
+            QVERIFY(maxDeviation(points, segments) < std::sqrt(2.5) + 0.05);
+
+            // Curves leave every joint, window boundaries included, in the
+            // direction the one before entered it, up to the rounding of the
+            // handles against the end point.
+            for (int i = 1; i < segments.count() - 1; ++i) {
+                QPointF in = segments.at(i).control1();
+                QPointF out = segments.at(i).control2();
+                qreal cross = in.x() * out.y() - in.y() * out.x();
+                qreal lengths = std::sqrt(QPointF::dotProduct(in, in)) + std::sqrt(QPointF::dotProduct(out, out));
+                QVERIFY(std::abs(cross) <= 1e-9 * lengths * (lengths + segments.at(i).endPoint().manhattanLength()));
+                QVERIFY(QPointF::dotProduct(in, out) <= 0);
+            }
+        }
+    }
+
+    // A file is mapped a window at a time, with the same curves.
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    QVERIFY(file.write(reinterpret_cast<const char *>(points.constData()), points.count() * sizeof(QPointF)) == qint64(points.count() * sizeof(QPointF)));
+    file.close();
+
+    SegmentSink expected;
+    SegmentSink mapped;
+    SimplifyQt::simplifyIsWindowed(points, expected, 2.5, 1000);
+    QVERIFY(SimplifyQt::simplifyIsFile(file.fileName(), mapped, 2.5, 1000));
+    QVERIFY(sameSegments(mapped.segments, expected.segments));
+
+    QTemporaryFile torn;
+    QVERIFY(torn.open());
+    QVERIFY(torn.write(reinterpret_cast<const char *>(points.constData()), sizeof(QPointF) + 1) == qint64(sizeof(QPointF) + 1));
+    torn.close();
+    SegmentSink none;
+    QVERIFY(!SimplifyQt::simplifyIsFile(torn.fileName(), none));
+    QVERIFY(!SimplifyQt::simplifyIsFile(torn.fileName() + QStringLiteral(".missing"), none));
+    QVERIFY(none.segments.isEmpty());
+
+    SimplifyQt::simplifyIsWindowed(QVector<QPointF>(), none);
+    QVERIFY(none.segments.isEmpty());
+    SimplifyQt::simplifyIsWindowed(points.mid(0, 1), none);
+    QVERIFY(none.segments.count() == 1);
+}
+
+void SimplifyTest::segmentCodec()
+{
+    QVector<SimplifyQt::Segment> segments = SimplifyQt::simplifyIs(points);
+
+    for (qreal maxError : { 1e-6, 0.01, 0.5, 40.0 }) {
+        QByteArray data = SimplifyQt::encodeSegments(segments, maxError);
+        bool ok = false;
+        QVector<SimplifyQt::Segment> decoded = SimplifyQt::decodeSegments(data, &ok);
+        QVERIFY(ok);
+        QVERIFY(decoded.count() == segments.count());
+
+        // End points and absolute control points, not the handles, are
+        // within the bound.
+        for (int i = 0; i < segments.count(); ++i) {
+            const SimplifyQt::Segment &a = segments.at(i);
+            const SimplifyQt::Segment &b = decoded.at(i);
+            const QPointF errors[3] = {
+                b.endPoint() - a.endPoint(),
+                (b.endPoint() + b.control1()) - (a.endPoint() + a.control1()),
+                (b.endPoint() + b.control2()) - (a.endPoint() + a.control2())
+            };
+            for (const QPointF &error : errors) {
+                QVERIFY(std::abs(error.x()) <= maxError);
+                QVERIFY(std::abs(error.y()) <= maxError);
+            }
+        }
+    }
+
+    // Points on the grid come back exactly, at a few bytes each.
+    QVector<SimplifyQt::Segment> grid;
+    grid.append(SimplifyQt::Segment(QPointF(-3, 7)));
+    grid.last().setControl2(QPointF(1, 0));
+    grid.append(SimplifyQt::Segment(QPointF(12, 5), QPointF(-2, 1)));
+    QByteArray data = SimplifyQt::encodeSegments(grid, 0.5);
+    QVERIFY(data.size() <= 1 + 1 + 8 + 2 * 6);
+    QVERIFY(sameSegments(SimplifyQt::decodeSegments(data), grid));
+
+    bool ok = false;
+    QVERIFY(SimplifyQt::decodeSegments(SimplifyQt::encodeSegments(QVector<SimplifyQt::Segment>(), 1), &ok).isEmpty());
+    QVERIFY(ok);
+
+    // Bounds that cannot be kept are refused.
+    QVERIFY(SimplifyQt::encodeSegments(grid, 0).isEmpty());
+    QVERIFY(SimplifyQt::encodeSegments(grid, -1).isEmpty());
+    QVERIFY(SimplifyQt::encodeSegments(QVector<SimplifyQt::Segment>() << SimplifyQt::Segment(QPointF(1e300, 0)), 1e-3).isEmpty());
+    QVERIFY(SimplifyQt::encodeSegments(QVector<SimplifyQt::Segment>() << SimplifyQt::Segment(QPointF(qQNaN(), 0)), 1).isEmpty());
+
+    // Anything but a whole encoding is rejected.
+    for (int size = 0; size < data.size(); ++size) {
+        QVERIFY(SimplifyQt::decodeSegments(data.left(size), &ok).isEmpty());
+        QVERIFY(!ok);
+    }
+    QVERIFY(SimplifyQt::decodeSegments(QByteArray(data).append(char(0)), &ok).isEmpty());
+    QVERIFY(!ok);
+    QByteArray version(data);
+    version[0] = char(2);
+    QVERIFY(SimplifyQt::decodeSegments(version, &ok).isEmpty());
+    QVERIFY(!ok);
+}
+
+void SimplifyTest::simplifier()
+{
+    QVector<QPointF> shorter = points.mid(0, 500);
+    QVector<QVector<SimplifyQt::Segment> > expected;
+    for (const QVector<QPointF> &input : { points, shorter, stroke }) {
+        expected.append(SimplifyQt::simplifyIs(input));
+    }
+
+    // The same segments as simplifyIs(), whatever came before.
+    SimplifyQt::Simplifier simplifier;
+    QVERIFY(sameSegments(simplifier.simplify(points), expected.at(0)));
+    QVERIFY(sameSegments(simplifier.simplify(shorter), expected.at(1)));
+    QVERIFY(sameSegments(simplifier.simplify(stroke), expected.at(2)));
+    QVERIFY(sameSegments(simplifier.simplify(points), expected.at(0)));
+    QVERIFY(simplifier.capacity() == stroke.count());
+    simplifier.setTolerance(10);
+    QVERIFY(sameSegments(simplifier.simplify(points), SimplifyQt::simplifyIs(points, 10)));
+    simplifier.setTolerance(2.5);
+    QVERIFY(simplifier.simplify(QVector<QPointF>()).isEmpty());
+
+    if (!AllocationCounter::isAvailable())
+        QSKIP("Heap allocations cannot be counted here");
+
+    // Once the buffers have grown, calls leave the heap alone.
+    AllocationCounter::reset();
+    for (int i = 0; i < 10; ++i) {
+        simplifier.simplify(points);
+        simplifier.simplify(shorter);
+        simplifier.simplify(stroke);
+    }
+    QVERIFY(AllocationCounter::allocations() == 0);
+
+    // After reserve() even the first call does.
+    SimplifyQt::Simplifier reserved;
+    reserved.reserve(stroke.count());
+    AllocationCounter::reset();
+    reserved.simplify(stroke);
+    reserved.simplify(points);
+    QVERIFY(AllocationCounter::allocations() == 0);
+    QVERIFY(sameSegments(reserved.simplify(points), expected.at(0)));
+}
+
+void SimplifyTest::balancedSplits()
+{
+    const QVector<QPointF> spikes = risingSpikes();
+
+    const SimplifyQt::PathKernels *kernels = SimplifyQt::pathKernels(SimplifyQt::SimdSse2);
+    if (!kernels)
+        kernels = SimplifyQt::pathKernels(SimplifyQt::SimdNone);
+
+    for (const QVector<QPointF> &input : { points, stroke, spikes }) {
+        SimplifyQt::PathFitterSw fitter(input);
+        QVERIFY(!fitter.isBalanced());
+        fitter.setBalanced(true);
+        QVERIFY(fitter.isBalanced());
+
+        QVector<SimplifyQt::Segment> segments;
+        SimplifyQt::FitStats stats;
+        SimplifyQt::FitStatsCollector collector(stats);
+        fitter.fit(segments, 2.5, collector);
+        QVERIFY(segments.first().endPoint() == input.first());
+        QVERIFY(segments.last().endPoint() == input.last());
+
+        // Every part keeps at most three quarters of a span of MinBalancedSpan
+        // edges or more, below that a split takes off at least one point.
+        const int depth = int(std::ceil(std::log(qreal(input.count())) / std::log(4.0 / 3.0))) + SimplifyQt::MinBalancedSpan;
+        QVERIFY(stats.maxDepth <= depth);
+
+        QVERIFY(sameSegments(segments, SimplifyQt::simplifySwBalanced(input)));
+        SimplifyQt::PathFitterIs exact(input, *kernels);
+        exact.setBalanced(true);
+        QVERIFY(sameSegments(segments, exact.fit(2.5)));
+        QVERIFY(SimplifyQt::simplifyIsBalanced(input).last().endPoint() == input.last());
+    }
+
+    // A curve is still only kept within the tolerance, wherever the spans
+    // were split; the plain fit is unchanged.
+    QVERIFY(maxDeviation(points, SimplifyQt::simplifySwBalanced(points)) < std::sqrt(2.5) + 0.05);
+    QVERIFY(maxDeviation(stroke, SimplifyQt::simplifyIsBalanced(stroke)) < std::sqrt(2.5) + 0.05);
+    QVERIFY(sameSegments(SimplifyQt::simplifySw(points), segmentsSw));
+
+    QVERIFY(SimplifyQt::simplifyIsBalanced(QVector<QPointF>()).isEmpty());
+    QVERIFY(SimplifyQt::simplifySwBalanced(points.mid(0, 1)).count() == 1);
+}
+
+void SimplifyTest::simplifyIsParallel()
+{
+    QBENCHMARK {
+        SimplifyQt::simplifyIsParallel(points);
+    }
+}
+
+void SimplifyTest::simplifyIsFloat()
+{
+    QBENCHMARK {
+        SimplifyQt::simplifyIsFloat(points);
+    }
+}
+
+void SimplifyTest::simplifyIsDense()
+{
+    QBENCHMARK {
+        SimplifyQt::simplifyIs(stroke);
+    }
+}
+
+void SimplifyTest::simplifyIsDecimated()
+{
+    QBENCHMARK {
+        SimplifyQt::simplifyIsDecimated(stroke);
+    }
+}
+
+void SimplifyTest::simplifyIsEachLevel()
+{
+    QBENCHMARK {
+        for (qreal tolerance : levelTolerances) {
+            SimplifyQt::simplifyIs(points, tolerance);
+        }
+    }
+}
+
+void SimplifyTest::simplifyIsLevels()
+{
+    QBENCHMARK {
+        SimplifyQt::simplifyIsLevels(points, levelTolerances);
+    }
+}
+
+void SimplifyTest::evaluate1()
+{
+    const QPointF curves[2] = { QPointF(1.3, 2.6), QPointF(1.3, 2.6) };
+    SimplifyQt::PowerBasis<1> basis = SimplifyQt::powerBasis<1>(curves);
+
+    QBENCHMARK {
+        SimplifyQt::evaluate(basis, 0.5);
+    }
+}
+
+void SimplifyTest::evaluate2()
+{
+    const QPointF curves[3] = { QPointF(1.3, 2.6), QPointF(1.3, 2.6), QPointF(1.3, 2.6) };
+    SimplifyQt::PowerBasis<2> basis = SimplifyQt::powerBasis<2>(curves);
+
+    QBENCHMARK {
+        SimplifyQt::evaluate(basis, 0.5);
+    }
+}
+
+void SimplifyTest::evaluate3()
+{
+    const QPointF curves[4] = { QPointF(1.3, 2.6), QPointF(1.3, 2.6), QPointF(1.3, 2.6), QPointF(1.3, 2.6) };
+    SimplifyQt::PowerBasis<3> basis = SimplifyQt::powerBasis<3>(curves);
+
+    QBENCHMARK {
+        SimplifyQt::evaluate(basis, 0.5);
+    }
+}
+
+void SimplifyTest::findMaxErrorSw()
+{
+    SimplifyQt::PathFitterSw fitter(points);
+    QVector<qreal> u(1000);
+    fitter.chordLengthParameterize(0, 999, u.data());
+
+    QPointF curves[4];
+    fitter.generateBezier(0, 999, u.constData(), points[1] - points[0], points[998] - points[999], curves);
+
+    QBENCHMARK {
+        fitter.findMaxError(0, 999, curves, u.constData());
+    }
+}
+
+void SimplifyTest::findMaxErrorIs()
+{
+    SimplifyQt::PathFitterIs fitter(points);
+    QVector<qreal> u(1000);
+    fitter.chordLengthParameterize(0, 999, u.data());
+
+    QPointF curves[4];
+    fitter.generateBezier(0, 999, u.constData(), points[1] - points[0], points[998] - points[999], curves);
+
+    QBENCHMARK {
+        fitter.findMaxError(0, 999, curves, u.constData());
+    }
+}
+
+void SimplifyTest::dotSw()
+{
+    QPointF o(1.3, 2.6);
+    QPointF p(2.3, 3.6);
+
+    QBENCHMARK {
+        SimplifyQt::PathFitterSw::dot(o, p);
+    }
+}
+
+void SimplifyTest::dotIs()
+{
+    QPointF o(1.3, 2.6);
+    QPointF p(2.3, 3.6);
+
+    QBENCHMARK {
+        SimplifyQt::PathFitterIs::dot(o, p);
+    }
+}
+
+void SimplifyTest::getDistanceSw()
+{
+    QPointF o(1.3, 2.6);
+    QPointF p(2.3, 3.6);
+
+    QBENCHMARK {
+        SimplifyQt::PathFitterSw::getDistance(o, p);
+    }
+}
+
+void SimplifyTest::getDistanceIs()
+{
+    QPointF o(1.3, 2.6);
+    QPointF p(2.3, 3.6);
+
+    QBENCHMARK {
+        SimplifyQt::PathFitterIs::getDistance(o, p);
+    }
+}
+
+void SimplifyTest::normalizeSw()
+{
+    QPointF o(1.3, 2.6);
+
+    QBENCHMARK {
+        SimplifyQt::PathFitterSw::normalize(o);
+    }
+}
+
+void SimplifyTest::normalizeIs()
+{
+    QPointF o(1.3, 2.6);
+
+    QBENCHMARK {
+        SimplifyQt::PathFitterIs::normalize(o);
+    }
+}
+
+void SimplifyTest::getLengthSw()
+{
+    QPointF o(1.3, 2.6);
+
+    QBENCHMARK {
+        SimplifyQt::PathFitterSw::getLength(o);
+    }
+}
+
+void SimplifyTest::getLengthIs()
+{
+    QPointF o(1.3, 2.6);
+
+    QBENCHMARK {
+        SimplifyQt::PathFitterIs::getLength(o);
+    }
+}
+
+QTEST_APPLESS_MAIN(SimplifyTest)
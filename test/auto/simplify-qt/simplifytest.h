@@ -16,22 +16,45 @@ private slots:
 private slots:
     void simplifySw();
     void simplifyIs();
+    void simplifyIsParallel();
+    void simplifyIsFloat();
+    void simplifyIsDense();
+    void simplifyIsDecimated();
+    void simplifyIsEachLevel();
+    void simplifyIsLevels();
 private:
     QVector<SimplifyQt::Segment> segmentsSw;
     QVector<SimplifyQt::Segment> segmentsIs;
 
 private slots:
     void compareSegments();
+    void compareKernels();
+    void deepSplits();
+    void compareParallel();
+    void streaming();
+    void batch();
+    void pointSpans();
+    void curveSinks();
+    void compareFloat();
+    void decimation();
+    void levels();
+    void fitCache();
+    void fitStats();
+    void reparameterize();
+    void powerBasis();
+    void corners();
+    void windowed();
+    void segmentCodec();
+    void simplifier();
+    void balancedSplits();
 
 public slots:
-    void evaluate1Sw();
-    void evaluate1Is();
+    void evaluate1();
+    void evaluate2();
+    void evaluate3();
 public slots:
-    void evaluate2Sw();
-    void evaluate2Is();
-public slots:
-    void evaluate3Sw();
-    void evaluate3Is();
+    void findMaxErrorSw();
+    void findMaxErrorIs();
 
 public slots:
     void dotSw();
@@ -48,6 +71,7 @@ public slots:
 
 private:
     QVector<QPointF> points;
+    QVector<QPointF> stroke;
 };
 
 #endif // SIMPLIFYTEST_H
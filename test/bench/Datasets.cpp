@@ -0,0 +1,216 @@
+#include "Datasets.h"
+
+#include <cmath>
+
+namespace Datasets {
+
+static const double Pi = 3.14159265358979323846;
+
+// class Random
+
+quint64 Random::next()
+{
+    // SplitMix64
+    quint64 z = (state += Q_UINT64_C(0x9E3779B97F4A7C15));
+    z = (z ^ (z >> 30)) * Q_UINT64_C(0xBF58476D1CE4E5B9);
+    z = (z ^ (z >> 27)) * Q_UINT64_C(0x94D049BB133111EB);
+    return z ^ (z >> 31);
+}
+
+double Random::uniform()
+{
+    // The top 53 bits, exact in a double.
+    return double(next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+double Random::uniform(double low, double high)
+{
+    return low + (high - low) * uniform();
+}
+
+double Random::normal()
+{
+    double u1 = 1.0 - uniform();
+    double u2 = uniform();
+    return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * Pi * u2);
+}
+
+// Generators
+
+QVector<QPointF> randomWalk(int count, quint64 seed)
+{
+    Random random(seed);
+    QVector<QPointF> points;
+    points.reserve(count);
+
+    int yoffset = 0;
+    for (int i = 0; i < count; ++i) {
+        int r = int(random.next() % 50) - 25;
+        points.append(QPointF(i * 3, r + 100 + yoffset));
+        yoffset += r;
+    }
+
+    return points;
+}
+
+QVector<QPointF> splineNoise(int count, quint64 seed)
+{
+    Random random(seed);
+    QVector<QPointF> points;
+    points.reserve(count);
+
+    const int samples = 200;
+    QPointF p[4];
+    p[0] = QPointF(0, 0);
+    for (int k = 1; k < 4; ++k) {
+        p[k] = p[k - 1] + QPointF(random.uniform(100, 300), random.uniform(-150, 150));
+    }
+
+    for (int i = 0; i < count; ++i) {
+        int s = i % samples;
+        if ((s == 0) && (i > 0)) {
+            p[0] = p[1];
+            p[1] = p[2];
+            p[2] = p[3];
+            p[3] = p[2] + QPointF(random.uniform(100, 300), random.uniform(-150, 150));
+        }
+
+        // Catmull-Rom between p[1] and p[2].
+        double t = double(s) / samples;
+        double t2 = t * t;
+        double t3 = t2 * t;
+        QPointF point = 0.5 * ((2 * p[1])
+                               + (p[2] - p[0]) * t
+                               + (2 * p[0] - 5 * p[1] + 4 * p[2] - p[3]) * t2
+                               + (3 * p[1] - p[0] - 3 * p[2] + p[3]) * t3);
+        points.append(point + 0.5 * QPointF(random.normal(), random.normal()));
+    }
+
+    return points;
+}
+
+QVector<QPointF> gpsTrack(int count, quint64 seed)
+{
+    Random random(seed);
+    QVector<QPointF> points;
+    points.reserve(count);
+
+    // UTM-like easting and northing.
+    QPointF position(500000.0, 4500000.0);
+    double heading = random.uniform(0, 2 * Pi);
+    double speed = 12.0;
+    int stop = 0;
+
+    for (int i = 0; i < count; ++i) {
+        if (stop > 0) {
+            --stop;
+        } else {
+            if (random.uniform() < 0.002)
+                stop = int(random.uniform(10, 120));
+            heading += 0.05 * random.normal();
+            if (random.uniform() < 0.01)
+                heading += random.uniform(-Pi / 2, Pi / 2);
+            speed = qBound(2.0, speed + 0.5 * random.normal(), 35.0);
+            position += speed * QPointF(std::cos(heading), std::sin(heading));
+        }
+        points.append(position + 3.0 * QPointF(random.normal(), random.normal()));
+    }
+
+    return points;
+}
+
+QVector<QPointF> handwriting(int count, quint64 seed)
+{
+    Random random(seed);
+    QVector<QPointF> points;
+    points.reserve(count);
+
+    // A letter is about 400 samples: a loop of random size and slant while
+    // the pen moves right; a new letter picks new ones.
+    const int letter = 400;
+    double size = 0;
+    double slant = 0;
+    double ratio = 0;
+    double x = 0;
+
+    for (int i = 0; i < count; ++i) {
+        if (i % letter == 0) {
+            size = random.uniform(8, 20);
+            slant = random.uniform(-0.3, 0.3);
+            ratio = random.uniform(1, 3);
+        }
+
+        double t = 2 * Pi * (i % letter) / letter;
+        x += 0.05;
+        double dy = size * std::sin(ratio * t);
+        double dx = 0.6 * size * std::sin(t) + slant * dy;
+        QPointF tremor = 0.02 * QPointF(random.normal(), random.normal());
+        points.append(QPointF(x + dx, dy) + tremor);
+    }
+
+    return points;
+}
+
+QVector<QPointF> zigzag(int count, quint64 seed)
+{
+    Random random(seed);
+    QVector<QPointF> points;
+    points.reserve(count);
+
+    for (int i = 0; i < count; ++i) {
+        double amplitude = random.uniform(5, 50);
+        points.append(QPointF(i, (i & 1) ? amplitude : -amplitude));
+    }
+
+    return points;
+}
+
+QVector<QPointF> risingSpikes(int count, quint64 seed)
+{
+    Random random(seed);
+    QVector<QPointF> points;
+    points.reserve(count);
+
+    // Heights grow with the square of x, faster than a cubic through a
+    // span can follow, so its last spike is always the furthest off; the
+    // jitter is smaller than the growth from one spike to the next.
+    for (int i = 0; i < count; ++i) {
+        double x = i;
+        points.append(QPointF(x, (i & 1) ? 0 : 10 + x * x + random.uniform(0, 1)));
+    }
+
+    return points;
+}
+
+QVector<QPointF> spikedZigzag(int count, quint64 seed)
+{
+    Random random(seed);
+    QVector<QPointF> points;
+    points.reserve(count);
+
+    for (int i = 0; i < count; ++i) {
+        double y = (i & 1) ? random.uniform(5, 10) : -random.uniform(5, 10);
+        if ((i % 5) == 0)
+            y = 20 + double(i) * i + random.uniform(0, 5);
+        points.append(QPointF(i, y));
+    }
+
+    return points;
+}
+
+const QVector<Dataset> &all()
+{
+    static const QVector<Dataset> datasets = {
+        { "randomWalk", randomWalk, false },
+        { "splineNoise", splineNoise, false },
+        { "gpsTrack", gpsTrack, false },
+        { "handwriting", handwriting, false },
+        { "zigzag", zigzag, false },
+        { "risingSpikes", risingSpikes, true },
+        { "spikedZigzag", spikedZigzag, true }
+    };
+
+    return datasets;
+}
+
+} // namespace Datasets
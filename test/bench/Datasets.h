@@ -0,0 +1,83 @@
+#ifndef DATASETS_H
+#define DATASETS_H
+
+#include <QPointF>
+#include <QVector>
+
+// Seeded point generators for the benchmarks. The random numbers come from
+// SplitMix64 and are turned into floating point by hand, not by <random>
+// distributions, so a seed gives the same uniform numbers with every
+// standard library. The points are only reproducible with the same libm:
+// normal() and most generators go through std::log, std::sin and std::cos,
+// which are not correctly rounded and differ in the last bits between
+// implementations.
+namespace Datasets {
+
+class Random
+{
+public:
+    explicit Random(quint64 seed)
+        : state(seed) {
+    }
+
+public:
+    quint64 next();
+
+    // Uniform in [0, 1).
+    double uniform();
+    // Uniform in [low, high).
+    double uniform(double low, double high);
+    // Standard normal, Box-Muller.
+    double normal();
+
+private:
+    quint64 state;
+}; // class Random
+
+// x steps of 3, y a random walk of integer steps in [-25, 25): the walk of
+// SimplifyTest, reproducible.
+QVector<QPointF> randomWalk(int count, quint64 seed);
+
+// A Catmull-Rom spline through control points about 200 samples apart,
+// with half a unit of Gaussian noise: smooth input a fit covers with few
+// long curves.
+QVector<QPointF> splineNoise(int count, quint64 seed);
+
+// A vehicle track in metres, one fix a second, millions of metres from the
+// origin: a wandering heading, changing speed, stops where only the 3 m
+// fix noise moves the point.
+QVector<QPointF> gpsTrack(int count, quint64 seed);
+
+// Pen strokes sampled at 0.05 units: loops and turns far smaller than
+// the spacing of the other sets, with tremor.
+QVector<QPointF> handwriting(int count, quint64 seed);
+
+// Every point alternately above and below the line by a random amount
+// well past the tolerance, so every span splits as deep as it can.
+QVector<QPointF> zigzag(int count, quint64 seed);
+
+// Every second point on the line, the others spikes growing with the square
+// of x: the point of largest error is always the last spike of a span, and
+// a fit that splits there cuts two points off at a time, quadratic work.
+QVector<QPointF> risingSpikes(int count, quint64 seed);
+
+// The zigzag with a spike like those of risingSpikes every fifth point:
+// the same worst case, with misses in between that a split may find first.
+QVector<QPointF> spikedZigzag(int count, quint64 seed);
+
+struct Dataset
+{
+    const char *name;
+    QVector<QPointF> (*generate)(int count, quint64 seed);
+
+    // Worst cases that take the plain fit quadratic time: not run unless
+    // asked for, and then with plain fits only at small sizes.
+    bool adversarial;
+};
+
+// All of the above, by name.
+const QVector<Dataset> &all();
+
+} // namespace Datasets
+
+#endif // DATASETS_H
@@ -0,0 +1,15 @@
+QT -= gui
+
+TEMPLATE = app
+
+CONFIG += qt console warn_on
+CONFIG -= app_bundle
+
+HEADERS += \
+    Datasets.h
+SOURCES += \
+    Datasets.cpp \
+    main.cpp
+
+include(../common/common.pri)
+include(../../src/simplify-qt/simplify-qt.pri)
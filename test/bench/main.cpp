@@ -0,0 +1,225 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+
+#include <algorithm>
+
+#include "AllocationCounter.h"
+#include "Datasets.h"
+#include "SimplifyQt.h"
+#include "private/PathKernels.h"
+
+// Fits every dataset at every size with every algorithm and writes one JSON
+// record per combination:
+//
+//   bench --sizes 100,10000,1000000 --datasets gpsTrack --output gps.json
+//
+// Times are wall clock per call; a call is repeated until minTime has
+// passed, the best and the median are reported. Allocations and peak bytes
+// are those of the first call, they do not change between calls.
+//
+// The adversarial datasets are only run when named, and then only
+// simplifyIsBalanced goes past AdversarialLimit points:
+//
+//   bench --datasets risingSpikes,spikedZigzag --sizes 1000,10000,1000000
+
+struct Algorithm
+{
+    const char *name;
+    int (*run)(const QVector<QPointF> &points, qreal tolerance);
+
+    // O(n log n) on every input, run on adversarial datasets at any size.
+    bool bounded;
+};
+
+// Largest adversarial input the other algorithms are run on: they take
+// quadratic time there, about a second at 10000 points.
+static const int AdversarialLimit = 10000;
+
+static const Algorithm algorithms[] = {
+    { "simplifySw", [](const QVector<QPointF> &points, qreal tolerance) {
+          return SimplifyQt::simplifySw(points, tolerance).count();
+      }, false },
+    { "simplifyIs", [](const QVector<QPointF> &points, qreal tolerance) {
+          return SimplifyQt::simplifyIs(points, tolerance).count();
+      }, false },
+    { "simplifyIsFloat", [](const QVector<QPointF> &points, qreal tolerance) {
+          return SimplifyQt::simplifyIsFloat(points, tolerance).count();
+      }, false },
+    { "simplifyIsDecimated", [](const QVector<QPointF> &points, qreal tolerance) {
+          return SimplifyQt::simplifyIsDecimated(points, tolerance).count();
+      }, false },
+    { "simplifyIsParallel", [](const QVector<QPointF> &points, qreal tolerance) {
+          return SimplifyQt::simplifyIsParallel(points, tolerance).count();
+      }, false },
+    { "simplifyIsCorners", [](const QVector<QPointF> &points, qreal tolerance) {
+          return SimplifyQt::simplifyIsCorners(points, tolerance).count();
+      }, false },
+    { "simplifyIsBalanced", [](const QVector<QPointF> &points, qreal tolerance) {
+          return SimplifyQt::simplifyIsBalanced(points, tolerance).count();
+      }, true }
+};
+
+static QStringList split(const QString &value)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    return value.split(QLatin1Char(','), Qt::SkipEmptyParts);
+#else
+    return value.split(QLatin1Char(','), QString::SkipEmptyParts);
+#endif
+}
+
+static QJsonObject measure(const Algorithm &algorithm, const QVector<QPointF> &points, qreal tolerance, double minTime)
+{
+    QVector<double> seconds;
+    QElapsedTimer timer;
+
+    AllocationCounter::reset();
+    timer.start();
+    int segments = algorithm.run(points, tolerance);
+    seconds.append(timer.nsecsElapsed() * 1e-9);
+    qint64 allocations = AllocationCounter::allocations();
+    qint64 peakBytes = AllocationCounter::peakBytes();
+
+    double total = seconds.first();
+    while (total < minTime) {
+        timer.start();
+        algorithm.run(points, tolerance);
+        seconds.append(timer.nsecsElapsed() * 1e-9);
+        total += seconds.last();
+    }
+
+    std::sort(seconds.begin(), seconds.end());
+    double best = seconds.first();
+    double median = seconds.at(seconds.count() / 2);
+
+    QJsonObject result;
+    result.insert(QStringLiteral("algorithm"), QLatin1String(algorithm.name));
+    result.insert(QStringLiteral("runs"), seconds.count());
+    result.insert(QStringLiteral("bestSeconds"), best);
+    result.insert(QStringLiteral("medianSeconds"), median);
+    result.insert(QStringLiteral("pointsPerSecond"), (best > 0) ? (points.count() / best) : 0.0);
+    result.insert(QStringLiteral("segments"), segments);
+    if (AllocationCounter::isAvailable()) {
+        result.insert(QStringLiteral("allocations"), double(allocations));
+        result.insert(QStringLiteral("peakBytes"), double(peakBytes));
+    } else {
+        result.insert(QStringLiteral("allocations"), QJsonValue());
+        result.insert(QStringLiteral("peakBytes"), QJsonValue());
+    }
+
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QStringList datasetNames;
+    QStringList defaultDatasets;
+    for (const Datasets::Dataset &dataset : Datasets::all()) {
+        datasetNames << QLatin1String(dataset.name);
+        if (!dataset.adversarial)
+            defaultDatasets << QLatin1String(dataset.name);
+    }
+    QStringList algorithmNames;
+    for (const Algorithm &algorithm : algorithms)
+        algorithmNames << QLatin1String(algorithm.name);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("simplify-qt benchmarks, results as JSON"));
+    parser.addHelpOption();
+    QCommandLineOption datasetsOption(QStringLiteral("datasets"), QStringLiteral("Datasets to run, all but the adversarial ones by default: ") + datasetNames.join(QLatin1Char(',')), QStringLiteral("names"), defaultDatasets.join(QLatin1Char(',')));
+    QCommandLineOption sizesOption(QStringLiteral("sizes"), QStringLiteral("Point counts to run."), QStringLiteral("counts"), QStringLiteral("100,1000,10000,100000,1000000,10000000"));
+    QCommandLineOption algorithmsOption(QStringLiteral("algorithms"), QStringLiteral("Algorithms to run: ") + algorithmNames.join(QLatin1Char(',')), QStringLiteral("names"), algorithmNames.join(QLatin1Char(',')));
+    QCommandLineOption toleranceOption(QStringLiteral("tolerance"), QStringLiteral("Fitting tolerance."), QStringLiteral("value"), QStringLiteral("2.5"));
+    QCommandLineOption seedOption(QStringLiteral("seed"), QStringLiteral("Seed of the generators."), QStringLiteral("value"), QStringLiteral("1"));
+    QCommandLineOption minTimeOption(QStringLiteral("min-time"), QStringLiteral("Seconds to repeat each measurement for."), QStringLiteral("seconds"), QStringLiteral("0.5"));
+    QCommandLineOption outputOption(QStringLiteral("output"), QStringLiteral("File to write, standard output if not given."), QStringLiteral("file"));
+    parser.addOptions({ datasetsOption, sizesOption, algorithmsOption, toleranceOption, seedOption, minTimeOption, outputOption });
+    parser.process(app);
+
+    const qreal tolerance = parser.value(toleranceOption).toDouble();
+    const quint64 seed = parser.value(seedOption).toULongLong();
+    const double minTime = parser.value(minTimeOption).toDouble();
+
+    QVector<int> sizes;
+    for (const QString &size : split(parser.value(sizesOption))) {
+        bool ok = false;
+        int count = size.toInt(&ok);
+        if (!ok || (count < 0)) {
+            qCritical("Invalid size: %s", qPrintable(size));
+            return 1;
+        }
+        sizes.append(count);
+    }
+
+    QVector<Datasets::Dataset> datasets;
+    for (const QString &name : split(parser.value(datasetsOption))) {
+        int i = datasetNames.indexOf(name);
+        if (i < 0) {
+            qCritical("Unknown dataset: %s", qPrintable(name));
+            return 1;
+        }
+        datasets.append(Datasets::all().at(i));
+    }
+
+    QVector<Algorithm> selected;
+    for (const QString &name : split(parser.value(algorithmsOption))) {
+        int i = algorithmNames.indexOf(name);
+        if (i < 0) {
+            qCritical("Unknown algorithm: %s", qPrintable(name));
+            return 1;
+        }
+        selected.append(algorithms[i]);
+    }
+
+    QJsonArray results;
+    for (const Datasets::Dataset &dataset : datasets) {
+        for (int size : sizes) {
+            // Each size is generated from the start, so the first 100 points
+            // of every size are the same.
+            QVector<QPointF> points = dataset.generate(size, seed);
+            for (const Algorithm &algorithm : selected) {
+                if (dataset.adversarial && (size > AdversarialLimit) && !algorithm.bounded)
+                    continue;
+
+                QJsonObject result = measure(algorithm, points, tolerance, minTime);
+                result.insert(QStringLiteral("dataset"), QLatin1String(dataset.name));
+                result.insert(QStringLiteral("points"), size);
+                results.append(result);
+
+                qInfo("%-12s %9d %-20s %12.0f points/s", dataset.name, size, algorithm.name,
+                      result.value(QStringLiteral("pointsPerSecond")).toDouble());
+            }
+        }
+    }
+
+    QJsonObject report;
+    report.insert(QStringLiteral("seed"), QString::number(seed));
+    report.insert(QStringLiteral("tolerance"), tolerance);
+    report.insert(QStringLiteral("minTime"), minTime);
+    report.insert(QStringLiteral("threads"), QThread::idealThreadCount());
+    report.insert(QStringLiteral("kernels"), QLatin1String(SimplifyQt::bestPathKernels().name));
+    report.insert(QStringLiteral("results"), results);
+    QByteArray json = QJsonDocument(report).toJson();
+
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || (file.write(json) != json.size())) {
+            qCritical("Cannot write %s", qPrintable(file.fileName()));
+            return 1;
+        }
+    } else {
+        QFile out;
+        out.open(stdout, QIODevice::WriteOnly);
+        out.write(json);
+    }
+
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+
+#if defined(__GLIBC__)
+#  include <malloc.h>
+#  include <errno.h>
+#  define ALLOCATIONCOUNTER_GLIBC
+#endif
+
+namespace AllocationCounter {
+
+static std::atomic<qint64> count(0);
+static std::atomic<qint64> live(0);
+static std::atomic<qint64> base(0);
+static std::atomic<qint64> peak(0);
+
+static inline qint64 usableSize(void *p)
+{
+#if defined(ALLOCATIONCOUNTER_GLIBC)
+    return p ? qint64(malloc_usable_size(p)) : 0;
+#else
+    Q_UNUSED(p);
+    return 0;
+#endif
+}
+
+static inline void allocated(void *p)
+{
+    if (!p)
+        return;
+
+    qint64 bytes = usableSize(p);
+    count.fetch_add(1, std::memory_order_relaxed);
+    qint64 now = live.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    qint64 seen = peak.load(std::memory_order_relaxed);
+    while ((now > seen) && !peak.compare_exchange_weak(seen, now, std::memory_order_relaxed)) {
+    }
+}
+
+static inline void released(qint64 bytes)
+{
+    live.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+bool isAvailable()
+{
+#if defined(ALLOCATIONCOUNTER_GLIBC)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void reset()
+{
+    qint64 now = live.load(std::memory_order_relaxed);
+    base.store(now, std::memory_order_relaxed);
+    peak.store(now, std::memory_order_relaxed);
+    count.store(0, std::memory_order_relaxed);
+}
+
+qint64 allocations()
+{
+    return count.load(std::memory_order_relaxed);
+}
+
+qint64 peakBytes()
+{
+    return peak.load(std::memory_order_relaxed) - base.load(std::memory_order_relaxed);
+}
+
+} // namespace AllocationCounter
+
+#if defined(ALLOCATIONCOUNTER_GLIBC)
+
+// The program's own definitions win over the ones in libc; glibc still
+// exports the real allocator under these names.
+extern "C" {
+
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *p, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *p);
+
+void *malloc(size_t size)
+{
+    void *p = __libc_malloc(size);
+    AllocationCounter::allocated(p);
+    return p;
+}
+
+void *calloc(size_t count, size_t size)
+{
+    void *p = __libc_calloc(count, size);
+    AllocationCounter::allocated(p);
+    return p;
+}
+
+void *realloc(void *p, size_t size)
+{
+    // A failed realloc leaves p as it was, unless it was asked to free it.
+    qint64 bytes = AllocationCounter::usableSize(p);
+    void *q = __libc_realloc(p, size);
+    if (q || (size == 0))
+        AllocationCounter::released(bytes);
+    AllocationCounter::allocated(q);
+    return q;
+}
+
+void *memalign(size_t alignment, size_t size)
+{
+    void *p = __libc_memalign(alignment, size);
+    AllocationCounter::allocated(p);
+    return p;
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void **result, size_t alignment, size_t size)
+{
+    void *p = memalign(alignment, size);
+    if (!p)
+        return ENOMEM;
+    *result = p;
+    return 0;
+}
+
+void free(void *p)
+{
+    AllocationCounter::released(AllocationCounter::usableSize(p));
+    __libc_free(p);
+}
+
+} // extern "C"
+
+#endif // ALLOCATIONCOUNTER_GLIBC
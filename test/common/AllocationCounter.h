@@ -0,0 +1,26 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <QtGlobal>
+
+// Counts heap allocations of the whole process by standing in for malloc()
+// and friends, which Qt containers and operator new both end up in. Only
+// glibc lets a program do that; elsewhere isAvailable() is false and the
+// counts stay 0.
+namespace AllocationCounter {
+
+bool isAvailable();
+
+// Starts a measurement: zeroes the count and makes the bytes live right now
+// the baseline of peakBytes().
+void reset();
+
+// Calls to malloc, calloc, realloc and the aligned ones since reset().
+qint64 allocations();
+
+// Most bytes live above the baseline at any time since reset().
+qint64 peakBytes();
+
+} // namespace AllocationCounter
+
+#endif // ALLOCATIONCOUNTER_H
@@ -0,0 +1,7 @@
+INCLUDEPATH += $$PWD
+
+# Counts heap allocations, for the tests and the benchmarks.
+HEADERS += \
+    $$PWD/AllocationCounter.h
+SOURCES += \
+    $$PWD/AllocationCounter.cpp
@@ -7,8 +7,24 @@
 #include <QGridLayout>
 #include <QRadioButton>
 
+#include "PainterPathSink.h"
+
+// Passes the curves that end at segments first up to last - 1 to sink.
+static void addCurves(SimplifyQt::CurveSink &sink, const QVector<SimplifyQt::Segment> &segments, int first, int last)
+{
+    for (int i = first; i < last; ++i) {
+        const SimplifyQt::Segment &l = segments.at(i - 1);
+        const SimplifyQt::Segment &s = segments.at(i);
+        sink.cubicTo(l.endPoint() + l.control2(),
+                     s.endPoint() + s.control1(),
+                     s.endPoint());
+    }
+}
+
 MainWindow::MainWindow(QWidget *parent)
     : QWidget(parent)
+    , pressed(false)
+    , pathSegments(0)
 {
     resize(800, 600);
     setWindowTitle("simplify-qt");
@@ -64,7 +80,8 @@ void MainWindow::create10kPoints()
 void MainWindow::createPoints(int xc, int yc)
 {
     points.clear();
-    segments.clear();
+    path = QPainterPath();
+    tailPath = QPainterPath();
 
     int w = width() - 20;
     int h = height() - 20;
@@ -84,7 +101,8 @@ void MainWindow::createPoints(int xc, int yc)
     QElapsedTimer timer;
     timer.start();
 
-    segments = SimplifyQt::simplifyIs(points);
+    SimplifyQt::PainterPathSink sink(path);
+    SimplifyQt::simplifyIs(points, sink);
     qint64 nsecs = timer.nsecsElapsed();
     int c = points.count();
 
@@ -96,11 +114,38 @@ void MainWindow::createPoints(int xc, int yc)
     qint64 us = nsecs % 1000000 / 1000;
 
     QString text = QString::fromLatin1("%1 points, %2 segments, %3.%4 ms")
-            .arg(c).arg(segments.count()).arg(ms).arg(us, 3, 10, QLatin1Char('0'));
+            .arg(c).arg((path.elementCount() + 2) / 3).arg(ms).arg(us, 3, 10, QLatin1Char('0'));
 
     setWindowTitle(text);
 }
 
+void MainWindow::updateStrokePaths(const QVector<SimplifyQt::Segment> &segments, int committed)
+{
+    // The curves into the first committed segments never change again and
+    // are appended to path once; only the open tail behind them is built
+    // again on every point.
+
+    if (segments.isEmpty())
+        return;
+
+    SimplifyQt::PainterPathSink sink(path);
+    if (pathSegments == 0) {
+        sink.moveTo(segments.first().endPoint());
+        pathSegments = 1;
+    }
+    if (committed > pathSegments) {
+        addCurves(sink, segments, pathSegments, committed);
+        pathSegments = committed;
+    }
+
+    tailPath = QPainterPath();
+    if (segments.count() > pathSegments) {
+        SimplifyQt::PainterPathSink tailSink(tailPath);
+        tailSink.moveTo(segments.at(pathSegments - 1).endPoint());
+        addCurves(tailSink, segments, pathSegments, segments.count());
+    }
+}
+
 void MainWindow::paintEvent(QPaintEvent *)
 {
     QPainter painter(this);
@@ -110,20 +155,8 @@ void MainWindow::paintEvent(QPaintEvent *)
     if (buttonTotal->isChecked() || buttonSegment->isChecked()) {
         painter.setPen(QPen(QColor(qRgb(0x00, 0x00, 0x00)), 7));
         // draw segments -->
-        if (!segments.isEmpty()) {
-            QPainterPath path;
-            SimplifyQt::Segment l = segments.first();
-            path.moveTo(l.endPoint());
-            for (int i = 1; i < segments.count(); ++i) {
-                SimplifyQt::Segment s = segments.at(i);
-                path.cubicTo(l.endPoint() + l.control2(),
-                             s.endPoint() + s.control1(),
-                             s.endPoint());
-
-                l = s;
-            }
-            painter.drawPath(path);
-        }
+        painter.drawPath(path);
+        painter.drawPath(tailPath);
         // <-- draw segments
     }
 
@@ -149,9 +182,14 @@ void MainWindow::mousePressEvent(QMouseEvent *event)
         pressed = true;
 
         points.clear();
-        segments.clear();
+        simplifier.reset();
+        path = QPainterPath();
+        tailPath = QPainterPath();
+        pathSegments = 0;
 
         points.append(event->pos());
+        simplifier.addPoint(event->pos());
+        updateStrokePaths(simplifier.segments(), simplifier.committedCount());
 
         update();
     }
@@ -161,12 +199,15 @@ void MainWindow::mouseMoveEvent(QMouseEvent *event)
 {
     if (event->buttons() & Qt::LeftButton) {
         points.append(event->pos());
+        simplifier.addPoint(event->pos());
+        updateStrokePaths(simplifier.segments(), simplifier.committedCount());
 
         update();
 
         // update title
 
-        setWindowTitle(QString::fromLatin1("simplify-qt: %1 points").arg(points.count()));
+        setWindowTitle(QString::fromLatin1("simplify-qt: %1 points, %2 segments")
+                       .arg(points.count()).arg(simplifier.segments().count()));
     }
 }
 
@@ -180,10 +221,13 @@ void MainWindow::mouseReleaseEvent(QMouseEvent *event)
         QElapsedTimer timer;
         timer.start();
 
-        segments = SimplifyQt::simplifyIs(points);
+        simplifier.addPoint(event->pos());
+        QVector<SimplifyQt::Segment> segments = simplifier.finish();
         qint64 nsecs = timer.nsecsElapsed();
         int c = points.count();
 
+        // Every curve is final now, the tail joins the path.
+        updateStrokePaths(segments, segments.count());
         update();
 
         // update title
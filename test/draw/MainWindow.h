@@ -1,9 +1,11 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include <QPainterPath>
 #include <QRadioButton>
 
 #include "SimplifyQt.h"
+#include "StreamingSimplifier.h"
 
 class MainWindow : public QWidget
 {
@@ -19,6 +21,8 @@ protected slots:
 protected:
     void createPoints(int xc, int yc);
 
+    void updateStrokePaths(const QVector<SimplifyQt::Segment> &segments, int committed);
+
 protected:
     void paintEvent(QPaintEvent *) Q_DECL_FINAL;
 
@@ -30,7 +34,10 @@ protected:
 private:
     bool pressed;
     QVector<QPointF> points;
-    QVector<SimplifyQt::Segment> segments;
+    QPainterPath path;
+    QPainterPath tailPath;
+    int pathSegments;
+    SimplifyQt::StreamingSimplifier simplifier;
 
 private:
     QRadioButton *buttonPoint;